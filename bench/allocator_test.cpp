@@ -0,0 +1,62 @@
+// Checks PoolAllocator corner cases that containers hit through copies and
+// rebinding. Exits non-zero on the first failed check.
+//
+//   g++ -std=c++17 -O2 -I. bench/allocator_test.cpp -o allocator_test
+#include <deque>
+#include <list>
+#include <map>
+
+#include "bench_util.h"
+#include "pool_allocator.h"
+
+int main() {
+  {
+    PoolAllocator<int> alloc;
+    std::list<int, PoolAllocator<int>> list(alloc);
+    std::list<int, PoolAllocator<int>> copy = list;
+    copy.push_back(1);
+    Check("copy of an empty std::list built from an explicit allocator",
+          list.empty() && copy.size() == 1);
+  }
+  {
+    PoolAllocator<int> alloc;
+    std::map<int, int, std::less<int>, PoolAllocator<std::pair<const int, int>>> map(alloc);
+    auto copy = map;
+    copy.emplace(1, 2);
+    Check("copy of an empty std::map built from an explicit allocator",
+          map.empty() && copy.size() == 1);
+  }
+  {
+    PoolAllocator<int> alloc;
+    PoolAllocator<long> rebound(alloc);
+    PoolAllocator<long> copy(rebound);
+    long* p = copy.allocate();
+    *p = 42;
+    bool ok = *p == 42;
+    copy.deallocate(p);
+    Check("copy of a rebound allocator that never allocated", ok);
+  }
+  {
+    std::list<int, PoolAllocator<int>> list;
+    for (int i = 0; i < 10; ++i) list.push_back(i);
+    std::list<int, PoolAllocator<int>> copy = list;
+    Check("copy of a non-empty std::list", copy == list);
+  }
+  {
+    // More elements than kBlockSize, so the deque's blocks and map come from
+    // the run caches, which the copy must not share with the original.
+    std::deque<int, PoolAllocator<int>> deque;
+    for (int i = 0; i < 5000; ++i) deque.push_back(i);
+    std::deque<int, PoolAllocator<int>> copy = deque;
+    for (int i = 0; i < 5000; ++i) {
+      copy.push_back(i);
+      copy.pop_front();
+      deque.push_front(i);
+      deque.pop_back();
+    }
+    bool ok = copy.size() == 5000 && deque.size() == 5000;
+    for (int i = 0; ok && i < 5000; ++i) ok = copy[i] == i && deque[i] == 4999 - i;
+    Check("copy of a std::deque past kBlockSize elements", ok);
+  }
+  return TestExitCode();
+}
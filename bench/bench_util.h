@@ -0,0 +1,50 @@
+#pragma once
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Runs `body` once and prints its wall time in milliseconds under `label`.
+template <typename Body>
+double RunTimed(const char* label, Body&& body) {
+  auto start = std::chrono::steady_clock::now();
+  body();
+  auto stop = std::chrono::steady_clock::now();
+  double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+  std::cout << std::left << std::setw(40) << label << std::right << std::fixed
+            << std::setprecision(2) << std::setw(10) << ms << " ms\n";
+  return ms;
+}
+
+// Keeps the optimizer from discarding a computed value.
+template <typename T>
+void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Resident set size in MiB, from /proc/self/statm.
+inline double ResidentMib() {
+  long pages = 0;
+  if (FILE* statm = std::fopen("/proc/self/statm", "r")) {
+    if (std::fscanf(statm, "%*s %ld", &pages) != 1) pages = 0;
+    std::fclose(statm);
+  }
+  return static_cast<double>(pages) * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1 << 20);
+}
+
+// Pass/fail programs print one line per check and exit with TestExitCode(),
+// which is non-zero once any check has failed.
+inline int& TestFailures() {
+  static int failures = 0;
+  return failures;
+}
+
+inline void Check(const std::string& name, bool ok) {
+  std::cout << (ok ? "ok    " : "FAIL  ") << name << "\n";
+  if (!ok) ++TestFailures();
+}
+
+inline int TestExitCode() { return TestFailures() == 0 ? 0 : 1; }
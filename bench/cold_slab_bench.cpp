@@ -0,0 +1,106 @@
+// Skewed read workload over ColdSlabPool: most reads hit the most recently
+// allocated records, a few hit the cold remainder, and compress_idle() runs
+// between rounds. Reports resident slab memory, the size of the compressed
+// store and the latency of reads that fault a slab back in, against the same
+// workload with compression off. Linux only; needs userfaultfd.
+//
+//   g++ -std=c++17 -O2 -pthread -I. bench/cold_slab_bench.cpp -o cold_slab_bench
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "bench_util.h"
+#include "cold_slab_pool.h"
+
+namespace {
+
+constexpr size_t kRecords = size_t{1} << 19;
+constexpr size_t kHotRecords = kRecords / 20;
+constexpr int kRounds = 12;
+constexpr int kReadsPerRound = 200000;
+constexpr int kColdReadEvery = 1000;
+
+struct Record {
+  uint64_t id;
+  uint32_t visits;
+  uint32_t flags;
+  double balance;
+  char name[32];
+  uint64_t history[6];
+};
+
+double Mib(size_t bytes) { return static_cast<double>(bytes) / (1 << 20); }
+
+bool Run(const char* label, bool compress) {
+  ColdSlabPool<Record> pool;
+  std::vector<Record*> records(kRecords);
+  for (size_t i = 0; i < kRecords; ++i) {
+    Record* record = new (pool.allocate()) Record{};
+    record->id = i;
+    record->flags = i % 7 == 0;
+    record->balance = static_cast<double>(i % 1000);
+    std::snprintf(record->name, sizeof(record->name), "customer-%zu", i);
+    records[i] = record;
+  }
+  std::cout << label << ": " << pool.slab_count() << " slabs, " << Mib(pool.resident_bytes())
+            << " MiB resident after fill\n";
+
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<size_t> hot(kRecords - kHotRecords, kRecords - 1);
+  std::uniform_int_distribution<size_t> cold(0, kRecords - kHotRecords - 1);
+  std::vector<double> fault_ns;
+  uint64_t checksum = 0;
+  uint64_t expected = 0;
+  RunTimed("  reads", [&] {
+    for (int round = 0; round < kRounds; ++round) {
+      for (int i = 0; i < kReadsPerRound; ++i) {
+        if (i % kColdReadEvery != 0) {
+          size_t index = hot(rng);
+          checksum += records[index]->id;
+          expected += index;
+          continue;
+        }
+        size_t index = cold(rng);
+        size_t faults = pool.fault_count();
+        auto start = std::chrono::steady_clock::now();
+        uint64_t id = records[index]->id;
+        auto stop = std::chrono::steady_clock::now();
+        if (pool.fault_count() != faults) {
+          fault_ns.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+        }
+        checksum += id;
+        expected += index;
+      }
+      if (compress) pool.compress_idle();
+    }
+  });
+  if (checksum != expected) {
+    std::cerr << "  checksum mismatch: records were corrupted\n";
+    return false;
+  }
+  std::cout << "  resident " << Mib(pool.resident_bytes()) << " MiB, compressed store "
+            << Mib(pool.compressed_bytes()) << " MiB, " << pool.compressed_slab_count()
+            << " compressed slabs, " << pool.fault_count() << " faults\n";
+  if (!fault_ns.empty()) {
+    std::sort(fault_ns.begin(), fault_ns.end());
+    double sum = 0;
+    for (double ns : fault_ns) sum += ns;
+    std::cout << "  faulting reads: mean " << sum / fault_ns.size() / 1000 << " us, p50 "
+              << fault_ns[fault_ns.size() / 2] / 1000 << " us, p99 "
+              << fault_ns[fault_ns.size() * 99 / 100] / 1000 << " us, max "
+              << fault_ns.back() / 1000 << " us\n";
+  }
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = Run("Compression off", false);
+  ok = Run("Compression on", true) && ok;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+// Mixed find/insert/erase throughput at 1..N threads: ConcurrentHashMap
+// against a mutex-striped std::unordered_map with PoolAllocator nodes. A last
+// case has one thread inserting and another erasing, and reports how much the
+// resident set grew, which stays flat only if chunks freed by the consumer
+// get back to the producer.
+//
+//   g++ -std=c++17 -O2 -pthread -I. bench/concurrent_map_bench.cpp -o concurrent_map_bench
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "bench_util.h"
+#include "concurrent_hash_map.h"
+#include "pool_allocator.h"
+
+namespace {
+
+constexpr int kKeys = 16384;
+constexpr int kOpsPerThread = 400000;
+constexpr size_t kStripes = 64;
+constexpr long kPipelineKeys = 3000000;
+constexpr long kPipelineLive = 1000;
+
+class StripedMap {
+ public:
+  bool insert(int key, int value) {
+    Stripe& stripe = StripeFor(key);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    return stripe.map.emplace(key, value).second;
+  }
+
+  bool find(int key, int& out) {
+    Stripe& stripe = StripeFor(key);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    auto it = stripe.map.find(key);
+    if (it == stripe.map.end()) return false;
+    out = it->second;
+    return true;
+  }
+
+  bool erase(int key) {
+    Stripe& stripe = StripeFor(key);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    return stripe.map.erase(key) != 0;
+  }
+
+ private:
+  // Each stripe holds about kKeys / kStripes entries, well inside one block.
+  struct alignas(64) Stripe {
+    std::mutex mutex;
+    std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                       PoolAllocator<std::pair<const int, int>, 4096>>
+        map;
+  };
+
+  Stripe& StripeFor(int key) { return stripes_[std::hash<int>{}(key) % kStripes]; }
+
+  Stripe stripes_[kStripes];
+};
+
+// 80% finds, 10% inserts, 10% erases over a fixed key range.
+template <typename Map>
+void RunMixed(Map& map, int threads) {
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([&map, t] {
+      std::mt19937 rng(t);
+      int found = 0;
+      for (int i = 0; i < kOpsPerThread; ++i) {
+        int key = static_cast<int>(rng() % kKeys);
+        unsigned op = rng() % 10;
+        int value;
+        if (op == 0) {
+          map.insert(key, i);
+        } else if (op == 1) {
+          map.erase(key);
+        } else {
+          found += map.find(key, value);
+        }
+      }
+      DoNotOptimize(found);
+    });
+  }
+  for (std::thread& worker : workers) worker.join();
+}
+
+// One producer inserts consecutive keys while one consumer erases them in
+// order, with at most kPipelineLive entries alive at a time.
+void RunPipeline() {
+  ConcurrentHashMap<long, long> map;
+  std::atomic<long> inserted{0};
+  std::atomic<long> erased{0};
+  double before = ResidentMib();
+  RunTimed("ConcurrentHashMap, 1 producer 1 consumer", [&] {
+    std::thread producer([&] {
+      for (long key = 0; key < kPipelineKeys; ++key) {
+        while (key - erased.load(std::memory_order_acquire) >= kPipelineLive) {
+          std::this_thread::yield();
+        }
+        map.insert(key, key);
+        inserted.store(key + 1, std::memory_order_release);
+      }
+    });
+    std::thread consumer([&] {
+      for (long key = 0; key < kPipelineKeys; ++key) {
+        while (inserted.load(std::memory_order_acquire) <= key) std::this_thread::yield();
+        map.erase(key);
+        erased.store(key + 1, std::memory_order_release);
+      }
+    });
+    producer.join();
+    consumer.join();
+  });
+  std::cout << "  resident set grew by " << ResidentMib() - before << " MiB, " << map.size()
+            << " entries left\n";
+}
+
+}  // namespace
+
+int main() {
+  int max_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  for (int threads = 1; threads <= max_threads; ++threads) {
+    std::string striped_label = "striped unordered_map, " + std::to_string(threads) + " threads";
+    std::string lock_free_label = "ConcurrentHashMap, " + std::to_string(threads) + " threads";
+    StripedMap striped;
+    ConcurrentHashMap<int, int> lock_free;
+    for (int key = 0; key < kKeys; key += 2) {
+      striped.insert(key, key);
+      lock_free.insert(key, key);
+    }
+    RunTimed(striped_label.c_str(), [&] { RunMixed(striped, threads); });
+    RunTimed(lock_free_label.c_str(), [&] { RunMixed(lock_free, threads); });
+  }
+  RunPipeline();
+}
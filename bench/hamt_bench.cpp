@@ -0,0 +1,60 @@
+// Versioned-map updates and lookups: PersistentHashMap against copying a
+// pool-backed std::map on every update.
+//
+//   g++ -std=c++17 -O2 -I. bench/hamt_bench.cpp -o hamt_bench
+#include <functional>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "bench_util.h"
+#include "persistent_hash_map.h"
+
+namespace {
+
+constexpr int kEntries = 1000;
+constexpr int kUpdates = 2000;
+constexpr int kLookups = 2000000;
+
+using PooledMap = std::map<int, int, std::less<int>, PoolAllocator<std::pair<const int, int>>>;
+
+}  // namespace
+
+int main() {
+  std::mt19937 rng(7);
+  std::vector<int> keys(kUpdates);
+  for (int& key : keys) key = static_cast<int>(rng() % kEntries);
+
+  PooledMap map;
+  PersistentHashMap<int, int> hamt;
+  for (int i = 0; i < kEntries; ++i) {
+    map.emplace(i, i);
+    hamt = hamt.set(i, i);
+  }
+
+  RunTimed("std::map copy-on-update", [&] {
+    for (int i = 0; i < kUpdates; ++i) {
+      PooledMap next(map.begin(), map.end());
+      next[keys[i]] = i;
+      map = std::move(next);
+    }
+  });
+  RunTimed("PersistentHashMap update", [&] {
+    for (int i = 0; i < kUpdates; ++i) {
+      PersistentHashMap<int, int> next = hamt.set(keys[i], i);
+      hamt.swap(next);
+    }
+  });
+
+  RunTimed("std::map lookup", [&] {
+    long sum = 0;
+    for (int i = 0; i < kLookups; ++i) sum += map.find(i % kEntries)->second;
+    DoNotOptimize(sum);
+  });
+  RunTimed("PersistentHashMap lookup", [&] {
+    long sum = 0;
+    for (int i = 0; i < kLookups; ++i) sum += *hamt.find(i % kEntries);
+    DoNotOptimize(sum);
+  });
+}
@@ -0,0 +1,165 @@
+// Pipeline of repeated immutable tuples drawn from a small skewed domain:
+// every thread interns its tuples into a shared HashConsPool, against giving
+// each tuple its own ConcurrentPool chunk. Reports time, pooled bytes and the
+// cost of comparing neighbours by pointer versus by value. A last case interns
+// on one thread and releases on another and reports resident set growth.
+//
+//   g++ -std=c++17 -O2 -pthread -I. bench/hash_cons_bench.cpp -o hash_cons_bench
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "bench_util.h"
+#include "concurrent_pool.h"
+#include "hash_cons_pool.h"
+#include "spsc_channel.h"
+
+namespace {
+
+constexpr int kThreads = 4;
+constexpr size_t kTuplesPerThread = 500000;
+constexpr int kDistinct = 20000;
+constexpr int kPipelineTuples = 3000000;
+
+struct Tuple {
+  int64_t source;
+  int64_t target;
+  int32_t kind;
+  int32_t weight;
+  double score;
+
+  bool operator==(const Tuple& other) const {
+    return source == other.source && target == other.target && kind == other.kind &&
+           weight == other.weight && score == other.score;
+  }
+};
+
+struct TupleHash {
+  size_t operator()(const Tuple& t) const noexcept {
+    uint64_t h = static_cast<uint64_t>(t.source) * 0x9E3779B97F4A7C15ull;
+    h = (h ^ static_cast<uint64_t>(t.target)) * 0xC2B2AE3D27D4EB4Full;
+    h = (h ^ (static_cast<uint64_t>(t.kind) << 32 | static_cast<uint32_t>(t.weight))) *
+        0x165667B19E3779F9ull;
+    return static_cast<size_t>(h ^ (h >> 31));
+  }
+};
+
+Tuple MakeTuple(int id) {
+  return Tuple{id / 100, id % 100, id % 7, id % 13, id * 0.5};
+}
+
+// Thread `t`'s tuple ids, skewed towards small ids.
+std::vector<int> Ids(int t) {
+  std::mt19937 rng(static_cast<unsigned>(t) + 1);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  std::vector<int> ids(kTuplesPerThread);
+  for (int& id : ids) {
+    double u = uniform(rng);
+    id = static_cast<int>(u * u * u * kDistinct);
+  }
+  return ids;
+}
+
+template <typename Body>
+void RunThreads(Body&& body) {
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) threads.emplace_back(body, t);
+  for (std::thread& thread : threads) thread.join();
+}
+
+template <typename Equal>
+size_t CountRepeats(const std::vector<const Tuple*>& tuples, Equal&& equal) {
+  size_t repeats = 0;
+  for (size_t i = 1; i < tuples.size(); ++i) repeats += equal(tuples[i - 1], tuples[i]);
+  return repeats;
+}
+
+// One stage interns fresh tuples and hands them to a second stage,
+// which releases them. Freed chunks must find their way back to the interning
+// thread for memory to stay flat.
+void RunPipeline() {
+  HashConsPool<Tuple, TupleHash> pool;
+  SpscRing<const Tuple, 1024> ring;
+  double before = ResidentMib();
+  RunTimed("HashConsPool intern -> release pipeline", [&] {
+    std::thread consumer([&] {
+      for (int received = 0; received < kPipelineTuples;) {
+        if (const Tuple* tuple = ring.pop()) {
+          pool.release(tuple);
+          ++received;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+    for (int i = 0; i < kPipelineTuples; ++i) {
+      const Tuple* tuple = pool.intern(MakeTuple(i));
+      while (!ring.push(tuple)) std::this_thread::yield();
+    }
+    consumer.join();
+  });
+  std::cout << "  resident set grew by " << ResidentMib() - before << " MiB, " << pool.size()
+            << " instances left\n";
+}
+
+}  // namespace
+
+int main() {
+  std::vector<std::vector<int>> ids(kThreads);
+  for (int t = 0; t < kThreads; ++t) ids[t] = Ids(t);
+  std::vector<std::vector<const Tuple*>> tuples(kThreads);
+
+  {
+    HashConsPool<Tuple, TupleHash> pool;
+    RunTimed("HashConsPool intern", [&] {
+      RunThreads([&](int t) {
+        tuples[t].reserve(kTuplesPerThread);
+        for (int id : ids[t]) tuples[t].push_back(pool.intern(MakeTuple(id)));
+      });
+    });
+    std::cout << "  " << pool.size() << " distinct of " << kThreads * kTuplesPerThread
+              << " tuples, " << pool.size() * sizeof(Tuple) / 1024 << " KiB of values\n";
+    size_t repeats = 0;
+    RunTimed("  compare neighbours by pointer", [&] {
+      for (const auto& list : tuples) {
+        repeats += CountRepeats(list, [](const Tuple* a, const Tuple* b) { return a == b; });
+      }
+    });
+    DoNotOptimize(repeats);
+    RunTimed("HashConsPool release", [&] {
+      RunThreads([&](int t) {
+        for (const Tuple* tuple : tuples[t]) pool.release(tuple);
+        tuples[t].clear();
+      });
+    });
+  }
+
+  {
+    ConcurrentPool<Tuple> pool;
+    RunTimed("ConcurrentPool copy per tuple", [&] {
+      RunThreads([&](int t) {
+        tuples[t].reserve(kTuplesPerThread);
+        for (int id : ids[t]) tuples[t].push_back(new (pool.allocate()) Tuple(MakeTuple(id)));
+      });
+    });
+    std::cout << "  " << kThreads * kTuplesPerThread << " copies, "
+              << kThreads * kTuplesPerThread * sizeof(Tuple) / 1024 << " KiB of values\n";
+    size_t repeats = 0;
+    RunTimed("  compare neighbours by value", [&] {
+      for (const auto& list : tuples) {
+        repeats += CountRepeats(list, [](const Tuple* a, const Tuple* b) { return *a == *b; });
+      }
+    });
+    DoNotOptimize(repeats);
+    RunTimed("ConcurrentPool destroy", [&] {
+      RunThreads([&](int t) {
+        for (const Tuple* tuple : tuples[t]) pool.destroy(const_cast<Tuple*>(tuple));
+      });
+    });
+  }
+
+  RunPipeline();
+}
@@ -0,0 +1,62 @@
+// Phased churn: each phase builds up a burst of short-lived temporaries,
+// interleaved with a trickle of long-lived records from a second call site,
+// then frees the temporaries and trims empty slabs. Memory still reserved
+// per live byte shows how many slabs the records pin with and without
+// lifetime segregation.
+//
+//   g++ -std=c++17 -O2 -I. bench/lifetime_pool_bench.cpp -o lifetime_pool_bench
+#include <vector>
+
+#include "bench_util.h"
+#include "lifetime_pool.h"
+
+namespace {
+
+constexpr int kPhases = 200;
+constexpr int kBurst = 20000;
+constexpr int kRecordEvery = 50;
+constexpr uint64_t kShortLifetime = 4 * kBurst;
+
+struct Object {
+  char bytes[64];
+};
+
+using Pool = LifetimePool<Object>;
+
+__attribute__((noinline)) Object* NewTemporary(Pool& pool) { return pool.allocate(); }
+__attribute__((noinline)) Object* NewRecord(Pool& pool) { return pool.allocate(); }
+
+void Churn(const char* label, bool segregate) {
+  Pool pool(segregate, kShortLifetime);
+  std::vector<Object*> temporaries;
+  std::vector<Object*> records;
+  size_t peak_slabs = 0;
+  double ratio_sum = 0;
+  RunTimed(label, [&] {
+    for (int phase = 0; phase < kPhases; ++phase) {
+      for (int i = 0; i < kBurst; ++i) {
+        if (i % kRecordEvery == 0) {
+          records.push_back(NewRecord(pool));
+        } else {
+          temporaries.push_back(NewTemporary(pool));
+        }
+      }
+      if (pool.slab_count() > peak_slabs) peak_slabs = pool.slab_count();
+      for (Object* temporary : temporaries) pool.deallocate(temporary);
+      temporaries.clear();
+      pool.trim();
+      ratio_sum += static_cast<double>(pool.reserved_bytes()) /
+                   static_cast<double>(pool.live() * sizeof(Object));
+    }
+  });
+  std::cout << "  peak slabs " << peak_slabs << ", slabs kept " << pool.slab_count()
+            << ", mean reserved/live after trim " << ratio_sum / kPhases << "\n";
+  for (Object* record : records) pool.deallocate(record);
+}
+
+}  // namespace
+
+int main() {
+  Churn("single arena churn", false);
+  Churn("lifetime-segregated churn", true);
+}
@@ -0,0 +1,96 @@
+// Event-store workload: events are appended in time order and freed in time
+// order after a fixed window, except for stragglers that live much longer.
+// Compares LogStructuredPool against PoolAllocator on time and on how much of
+// the reserved memory holds live events.
+//
+//   g++ -std=c++17 -O2 -I. bench/log_pool_bench.cpp -o log_pool_bench
+#include <cstdint>
+#include <deque>
+#include <utility>
+
+#include "bench_util.h"
+#include "log_pool.h"
+#include "pool_allocator.h"
+
+namespace {
+
+constexpr int64_t kEvents = 4000000;
+constexpr size_t kWindow = 10000;
+constexpr int64_t kStragglerEvery = 50;
+constexpr size_t kStragglerWindow = 50 * kWindow;
+// PoolAllocator cannot grow, so its block is sized for the peak live count
+// (about twice kWindow) up front.
+constexpr size_t kPoolCapacity = 1 << 15;
+
+struct Event {
+  int64_t timestamp;
+  char payload[56];
+};
+
+// Runs the workload with `alloc(timestamp)` returning a reference and
+// `release(reference)` freeing it.
+template <typename Ref, typename Alloc, typename Release>
+void Workload(Alloc&& alloc, Release&& release) {
+  std::deque<Ref> recent;
+  std::deque<Ref> stragglers;
+  for (int64_t t = 0; t < kEvents; ++t) {
+    Ref ref = alloc(t);
+    (t % kStragglerEvery == 0 ? stragglers : recent).push_back(ref);
+    if (recent.size() > kWindow) {
+      release(recent.front());
+      recent.pop_front();
+    }
+    if (stragglers.size() > kStragglerWindow / kStragglerEvery) {
+      release(stragglers.front());
+      stragglers.pop_front();
+    }
+  }
+}
+
+void RunLogPool(const char* label, double clean_threshold) {
+  LogStructuredPool<Event> pool(clean_threshold);
+  double utilization_sum = 0;
+  int64_t samples = 0;
+  using Handle = LogStructuredPool<Event>::Handle;
+  RunTimed(label, [&] {
+    Workload<Handle>(
+        [&](int64_t t) {
+          if (t % 1000 == 0) {
+            utilization_sum += pool.utilization();
+            ++samples;
+          }
+          return pool.allocate(Event{t, {}});
+        },
+        [&](Handle handle) { pool.free(handle); });
+  });
+  std::cout << "  mean utilization " << utilization_sum / samples << "\n";
+}
+
+}  // namespace
+
+int main() {
+  RunLogPool("LogStructuredPool, clean below 25%", 0.25);
+  RunLogPool("LogStructuredPool, clean below 50%", 0.5);
+  {
+    PoolAllocator<Event, kPoolCapacity> pool;
+    double utilization_sum = 0;
+    int64_t samples = 0;
+    size_t live = 0;
+    RunTimed("PoolAllocator free list", [&] {
+      Workload<Event*>(
+          [&](int64_t t) {
+            if (t % 1000 == 0) {
+              utilization_sum += static_cast<double>(live) / kPoolCapacity;
+              ++samples;
+            }
+            ++live;
+            return new (pool.allocate()) Event{t, {}};
+          },
+          [&](Event* event) {
+            --live;
+            pool.deallocate(event);
+          });
+    });
+    std::cout << "  mean utilization " << utilization_sum / samples << "\n";
+  }
+}
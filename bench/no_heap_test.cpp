@@ -0,0 +1,97 @@
+// Checks that warmed-up pool-backed hot paths make no heap allocations, and
+// that the guard does see allocations from the standard allocator. Exits
+// non-zero on the first failed check.
+//
+//   g++ -std=c++17 -O2 -pthread -I. bench/no_heap_test.cpp -o no_heap_test
+#define NO_HEAP_GUARD_IMPLEMENTATION
+#include "no_heap_guard.h"
+
+#include <deque>
+#include <iostream>
+#include <list>
+#include <string>
+
+#include "bench_util.h"
+#include "pool_allocator.h"
+#include "pooled_string.h"
+#include "realtime_pool.h"
+#include "spsc_channel.h"
+
+namespace {
+
+// Runs `body` under a counting guard and compares the allocation count.
+template <typename Body>
+void CheckHeap(const char* name, bool expect_heap, Body&& body) {
+  size_t allocations;
+  {
+    NoHeapGuard guard;
+    body();
+    allocations = guard.allocations();
+  }
+  Check(std::string(name) + ": " + std::to_string(allocations) + " allocations",
+        expect_heap ? allocations > 0 : allocations == 0);
+}
+
+}  // namespace
+
+int main() {
+  if (!NoHeapGuard::hooks_installed()) {
+    std::cout << "FAIL  interception hooks are not installed\n";
+    return 1;
+  }
+
+  CheckHeap("std::list with std::allocator", true, [] {
+    std::list<int> list;
+    for (int i = 0; i < 100; ++i) list.push_back(i);
+  });
+
+  std::list<int, PoolAllocator<int>> list;
+  CheckHeap("std::list with PoolAllocator", false, [&] {
+    for (int round = 0; round < 100; ++round) {
+      for (int i = 0; i < 500; ++i) list.push_back(i);
+      while (!list.empty()) list.pop_front();
+    }
+  });
+
+  std::deque<int, PoolAllocator<int>> deque;
+  for (int i = 0; i < 5000; ++i) deque.push_back(i);
+  CheckHeap("std::deque with PoolAllocator, warmed up", false, [&] {
+    for (int round = 0; round < 1000; ++round) {
+      deque.push_back(round);
+      deque.pop_front();
+    }
+  });
+
+  StringBufferPool string_pool;
+  {
+    // Growing one string walks through every size class, giving each a slab.
+    PooledString warm(string_pool);
+    for (int i = 0; i < 200; ++i) warm.push_back('x');
+  }
+  CheckHeap("PooledString appends within pooled classes", false, [&] {
+    for (int round = 0; round < 100; ++round) {
+      PooledString s(string_pool);
+      for (int i = 0; i < 200; ++i) s.push_back('x');
+    }
+  });
+
+  CheckHeap("std::string appends", true, [] {
+    std::string s;
+    for (int i = 0; i < 200; ++i) s.push_back('x');
+  });
+
+  SpscChannel<long> channel;
+  CheckHeap("SpscChannel send/receive", false, [&] {
+    for (long i = 0; i < 100000; ++i) {
+      channel.try_send(i);
+      channel.release(channel.try_receive());
+    }
+  });
+
+  RealTimePool<long, 1024> realtime(/*require_lock=*/false);
+  CheckHeap("RealTimePool allocate/deallocate", false, [&] {
+    for (int i = 0; i < 100000; ++i) realtime.deallocate(realtime.allocate());
+  });
+
+  return TestExitCode();
+}
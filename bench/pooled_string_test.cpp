@@ -0,0 +1,52 @@
+// Checks PooledString operations whose argument views the string itself, as
+// std::string allows. Exits non-zero on the first failed check.
+//
+//   g++ -std=c++17 -O2 -I. bench/pooled_string_test.cpp -o pooled_string_test
+#include <string>
+
+#include "bench_util.h"
+#include "pooled_string.h"
+
+namespace {
+
+void CheckString(const char* name, const PooledString& actual, const std::string& expected) {
+  Check(name, actual == expected && actual.size() == expected.size());
+}
+
+}  // namespace
+
+int main() {
+  const std::string pooled = "0123456789abcdefghij";
+  const std::string local = "0123456789";
+  {
+    PooledString s(pooled);
+    s += s;
+    CheckString("append self from a pooled buffer", s, pooled + pooled);
+  }
+  {
+    PooledString s(local);
+    s += s;
+    CheckString("append self from the inline buffer", s, local + local);
+  }
+  {
+    PooledString s(pooled);
+    s.append(s.view().substr(5, 10));
+    CheckString("append a substring of self", s, pooled + pooled.substr(5, 10));
+  }
+  {
+    PooledString s(pooled);
+    s = s.view().substr(3);
+    CheckString("assign a suffix of self", s, pooled.substr(3));
+  }
+  {
+    PooledString s(pooled);
+    s = s.view().substr(0, 4);
+    CheckString("assign a prefix of self", s, pooled.substr(0, 4));
+  }
+  {
+    PooledString s(pooled);
+    s = s;
+    CheckString("self copy-assignment", s, pooled);
+  }
+  return TestExitCode();
+}
@@ -0,0 +1,118 @@
+// Worst-case latency harness for RealTimePool. Runs a random allocate /
+// deallocate mix on the calling thread while other threads stream through
+// memory, timing every pool call. Exits with status 1 if any call exceeds the
+// bound.
+//
+//   g++ -std=c++17 -O2 -pthread -I. bench/realtime_latency.cpp -o realtime_latency
+//   ./realtime_latency [operations=1000000000] [bound_ns=20000]
+//
+// Run as a user allowed to mlock() and to use SCHED_FIFO for meaningful
+// numbers; otherwise the harness warns and measures anyway.
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "realtime_pool.h"
+
+namespace {
+
+constexpr size_t kCapacity = 1 << 16;
+constexpr size_t kLoadBytes = size_t{64} << 20;
+constexpr uint64_t kWarmupOperations = 100000;
+
+struct Sample {
+  char bytes[64];
+};
+
+void StartLoad(std::vector<std::thread>& threads, std::atomic<bool>& stop) {
+  unsigned count = std::max(1u, std::thread::hardware_concurrency() - 1);
+  for (unsigned i = 0; i < count; ++i) {
+    threads.emplace_back([&stop, i] {
+      std::vector<char> buffer(kLoadBytes);
+      for (int round = 0; !stop.load(std::memory_order_relaxed); ++round) {
+        std::memset(buffer.data(), round + static_cast<int>(i), buffer.size());
+      }
+    });
+  }
+}
+
+void EnterRealTime() {
+  if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+    std::cerr << "warning: mlockall failed: " << std::strerror(errno) << "\n";
+  }
+  sched_param param{};
+  param.sched_priority = sched_get_priority_max(SCHED_FIFO);
+  if (int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param)) {
+    std::cerr << "warning: SCHED_FIFO unavailable: " << std::strerror(error) << "\n";
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  uint64_t operations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000000ull;
+  int64_t bound_ns = argc > 2 ? std::strtoll(argv[2], nullptr, 10) : 20000;
+
+  RealTimePool<Sample, kCapacity> pool(/*require_lock=*/false);
+  if (!pool.is_locked()) std::cerr << "warning: pool memory is not locked\n";
+  std::vector<Sample*> live;
+  live.reserve(kCapacity);
+
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> load;
+  StartLoad(load, stop);
+  EnterRealTime();
+
+  // Latency histogram in power-of-two nanosecond buckets.
+  uint64_t histogram[64] = {};
+  int64_t worst_ns = 0;
+  std::minstd_rand rng(1);
+  for (uint64_t i = 0; i < kWarmupOperations + operations; ++i) {
+    bool allocate = live.empty() || (live.size() < kCapacity && (rng() & 1));
+    size_t victim = allocate ? 0 : rng() % live.size();
+    auto start = std::chrono::steady_clock::now();
+    if (allocate) {
+      live.push_back(pool.allocate());
+    } else {
+      pool.deallocate(live[victim]);
+    }
+    auto stop_time = std::chrono::steady_clock::now();
+    if (!allocate) {
+      live[victim] = live.back();
+      live.pop_back();
+    }
+    if (i < kWarmupOperations) continue;
+    int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(stop_time - start).count();
+    if (ns > worst_ns) worst_ns = ns;
+    ++histogram[ns > 0 ? 64 - __builtin_clzll(static_cast<uint64_t>(ns)) : 0];
+  }
+
+  stop.store(true);
+  for (std::thread& thread : load) thread.join();
+
+  for (int b = 0; b < 64; ++b) {
+    if (histogram[b]) {
+      std::cout << "<= " << (b ? (uint64_t{1} << b) - 1 : 0) << " ns: " << histogram[b] << "\n";
+    }
+  }
+  std::cout << "operations: " << operations << ", worst: " << worst_ns
+            << " ns, bound: " << bound_ns << " ns\n";
+  if (worst_ns > bound_ns) {
+    std::cout << "FAIL: worst-case latency exceeds the bound\n";
+    return 1;
+  }
+  std::cout << "PASS\n";
+  return 0;
+}
@@ -0,0 +1,64 @@
+// Random lookups in trees bulk-built from sorted input, comparing node
+// layouts against a pool-backed std::map filled in key order.
+//
+//   g++ -std=c++17 -O2 -I. bench/search_tree_bench.cpp -o search_tree_bench
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench_util.h"
+#include "pooled_search_tree.h"
+
+namespace {
+
+constexpr size_t kEntries = size_t{1} << 20;
+constexpr int kLookups = 1000000;
+
+using PooledMap = std::map<long, long, std::less<long>,
+                           PoolAllocator<std::pair<const long, long>, kEntries>>;
+
+template <typename Find>
+void Lookups(const char* label, const std::vector<long>& probes, Find&& find) {
+  RunTimed(label, [&] {
+    long sum = 0;
+    for (long key : probes) sum += find(key);
+    DoNotOptimize(sum);
+  });
+}
+
+}  // namespace
+
+int main() {
+  std::vector<std::pair<long, long>> sorted;
+  sorted.reserve(kEntries);
+  for (size_t i = 0; i < kEntries; ++i) sorted.emplace_back(static_cast<long>(i) * 3, i);
+
+  std::mt19937_64 rng(3);
+  std::vector<long> probes(kLookups);
+  for (long& key : probes) key = static_cast<long>(rng() % kEntries) * 3;
+
+  PooledMap map;
+  RunTimed("std::map build", [&] {
+    for (const auto& entry : sorted) map.emplace_hint(map.end(), entry);
+  });
+  Lookups("std::map lookup", probes, [&](long key) { return map.find(key)->second; });
+
+  const std::pair<TreeLayout, const char*> layouts[] = {
+      {TreeLayout::kSorted, "sorted"},
+      {TreeLayout::kBreadthFirst, "breadth-first"},
+      {TreeLayout::kVanEmdeBoas, "van Emde Boas"},
+  };
+  for (const auto& [layout, name] : layouts) {
+    std::string build_label = std::string("bulk build, ") + name;
+    std::string lookup_label = std::string("lookup, ") + name;
+    std::unique_ptr<PooledSearchTree<long, long>> tree;
+    RunTimed(build_label.c_str(), [&] {
+      tree = std::make_unique<PooledSearchTree<long, long>>(sorted.begin(), sorted.end(), layout);
+    });
+    Lookups(lookup_label.c_str(), probes, [&](long key) { return *tree->find(key); });
+  }
+}
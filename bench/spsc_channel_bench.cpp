@@ -0,0 +1,119 @@
+// Producer-to-consumer message passing: SpscChannel with recycled messages
+// against a mutex-guarded std::queue that allocates a message per send.
+//
+//   g++ -std=c++17 -O2 -pthread -I. bench/spsc_channel_bench.cpp -o spsc_channel_bench
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "bench_util.h"
+#include "spsc_channel.h"
+
+namespace {
+
+constexpr int kMessages = 2000000;
+constexpr int kLatencySamples = 20000;
+
+struct Message {
+  int64_t sequence;
+  std::chrono::steady_clock::time_point sent;
+  char payload[48];
+};
+
+class LockedQueue {
+ public:
+  void send(int64_t sequence) {
+    auto message = std::make_unique<Message>();
+    message->sequence = sequence;
+    message->sent = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push(std::move(message));
+  }
+
+  std::unique_ptr<Message> receive() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (queue_.empty()) return nullptr;
+    std::unique_ptr<Message> message = std::move(queue_.front());
+    queue_.pop();
+    return message;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::queue<std::unique_ptr<Message>> queue_;
+};
+
+void PrintLatency(const char* label, std::vector<double>& samples) {
+  std::sort(samples.begin(), samples.end());
+  std::cout << label << " latency p50 " << samples[samples.size() / 2] << " ns, p99 "
+            << samples[samples.size() * 99 / 100] << " ns\n";
+}
+
+double Nanoseconds(std::chrono::steady_clock::time_point sent) {
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - sent)
+      .count();
+}
+
+}  // namespace
+
+int main() {
+  std::vector<double> latencies;
+  latencies.reserve(kLatencySamples);
+
+  {
+    SpscChannel<Message> channel;
+    RunTimed("SpscChannel throughput", [&] {
+      std::thread consumer([&] {
+        for (int received = 0; received < kMessages;) {
+          Message* message = channel.try_receive();
+          if (!message) {
+            std::this_thread::yield();
+            continue;
+          }
+          if (received % (kMessages / kLatencySamples) == 0) {
+            latencies.push_back(Nanoseconds(message->sent));
+          }
+          channel.release(message);
+          ++received;
+        }
+      });
+      for (int64_t i = 0; i < kMessages;) {
+        if (channel.try_send(Message{i, std::chrono::steady_clock::now(), {}})) {
+          ++i;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+      consumer.join();
+    });
+    PrintLatency("SpscChannel", latencies);
+  }
+
+  latencies.clear();
+  {
+    LockedQueue queue;
+    RunTimed("mutex + new/delete throughput", [&] {
+      std::thread consumer([&] {
+        for (int received = 0; received < kMessages;) {
+          std::unique_ptr<Message> message = queue.receive();
+          if (!message) {
+            std::this_thread::yield();
+            continue;
+          }
+          if (received % (kMessages / kLatencySamples) == 0) {
+            latencies.push_back(Nanoseconds(message->sent));
+          }
+          ++received;
+        }
+      });
+      for (int64_t i = 0; i < kMessages; ++i) queue.send(i);
+      consumer.join();
+    });
+    PrintLatency("mutex + new/delete", latencies);
+  }
+}
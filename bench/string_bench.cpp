@@ -0,0 +1,70 @@
+// Tokenizes synthetic "key=value" records into string vectors, comparing
+// std::string against PooledString.
+//
+//   g++ -std=c++17 -O2 -I. bench/string_bench.cpp -o string_bench
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench_util.h"
+#include "pooled_string.h"
+
+namespace {
+
+constexpr int kRecords = 20000;
+constexpr int kRounds = 5;
+
+std::vector<std::string> MakeRecords() {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> field_count(4, 12);
+  std::uniform_int_distribution<int> field_len(2, 120);
+  std::vector<std::string> records;
+  records.reserve(kRecords);
+  for (int i = 0; i < kRecords; ++i) {
+    std::string record;
+    for (int f = field_count(rng); f > 0; --f) {
+      record.append(field_len(rng) / 4 + 1, 'k');
+      record.push_back('=');
+      record.append(field_len(rng), 'v');
+      record.push_back(';');
+    }
+    records.push_back(std::move(record));
+  }
+  return records;
+}
+
+// Splits every record on '=' and ';' character by character, the way a
+// hand-written parser accumulates tokens.
+template <typename String>
+size_t Parse(const std::vector<std::string>& records) {
+  size_t total = 0;
+  std::vector<String> tokens;
+  for (const std::string& record : records) {
+    tokens.clear();
+    String token;
+    for (char c : record) {
+      if (c == '=' || c == ';') {
+        tokens.push_back(std::move(token));
+        token = String();
+      } else {
+        token.push_back(c);
+      }
+    }
+    for (const String& t : tokens) {
+      total += t.size();
+    }
+  }
+  return total;
+}
+
+}  // namespace
+
+int main() {
+  std::vector<std::string> records = MakeRecords();
+  RunTimed("std::string tokenize", [&] {
+    for (int r = 0; r < kRounds; ++r) DoNotOptimize(Parse<std::string>(records));
+  });
+  RunTimed("PooledString tokenize", [&] {
+    for (int r = 0; r < kRounds; ++r) DoNotOptimize(Parse<PooledString>(records));
+  });
+}
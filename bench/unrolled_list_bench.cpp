@@ -0,0 +1,90 @@
+// UnrolledList against std::list, both on PoolAllocator: sequential fill,
+// repeated traversal, and a mixed pass that walks the list inserting and
+// erasing as it goes.
+//
+//   g++ -std=c++17 -O2 -I. bench/unrolled_list_bench.cpp -o unrolled_list_bench
+#include <cstdint>
+#include <iostream>
+#include <list>
+
+#include "bench_util.h"
+#include "pool_allocator.h"
+#include "unrolled_list.h"
+
+namespace {
+
+constexpr int kElements = 500000;
+constexpr int kTraversals = 50;
+constexpr int kMixedPasses = 20;
+// PoolAllocator cannot grow, so each block is sized for the container's peak
+// node count: one node per element for std::list, and at worst one per four
+// elements for UnrolledList<int>.
+constexpr size_t kListNodes = 1 << 20;
+constexpr size_t kUnrolledNodes = 1 << 18;
+
+// Same pseudo-random decisions for both containers.
+struct XorShift {
+  uint32_t state = 2463534242u;
+
+  uint32_t operator()() noexcept {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+  }
+};
+
+template <typename List>
+void Run(const char* name, List& list) {
+  std::cout << name << "\n";
+  // Warm the pool so that first-touch page faults in its block stay out of
+  // the timings.
+  for (int i = 0; i < kElements; ++i) list.push_back(i);
+  list.clear();
+  RunTimed("  fill", [&] {
+    for (int i = 0; i < kElements; ++i) list.push_back(i);
+  });
+  RunTimed("  traverse", [&] {
+    int64_t sum = 0;
+    for (int pass = 0; pass < kTraversals; ++pass) {
+      for (int value : list) sum += value;
+    }
+    DoNotOptimize(sum);
+  });
+  // Each pass inserts before about one element in eight and erases about one
+  // in eight, so the size stays roughly constant.
+  RunTimed("  mixed insert/erase walk", [&] {
+    XorShift rng;
+    int64_t sum = 0;
+    for (int pass = 0; pass < kMixedPasses; ++pass) {
+      for (auto it = list.begin(); it != list.end();) {
+        uint32_t roll = rng() & 7;
+        if (roll == 0) {
+          it = list.insert(it, static_cast<int>(rng()));
+          ++it;
+        } else if (roll == 1) {
+          it = list.erase(it);
+          continue;
+        }
+        sum += *it;
+        ++it;
+      }
+    }
+    DoNotOptimize(sum);
+  });
+  std::cout << "  " << list.size() << " elements after the mixed walk\n";
+}
+
+}  // namespace
+
+int main() {
+  {
+    std::list<int, PoolAllocator<int, kListNodes>> list;
+    Run("std::list<int, PoolAllocator>", list);
+  }
+  {
+    UnrolledList<int, PoolAllocator<int, kUnrolledNodes>> list;
+    Run("UnrolledList<int, PoolAllocator>", list);
+    std::cout << "  " << list.node_count() << " nodes of " << list.kNodeCapacity << " slots\n";
+  }
+}
@@ -0,0 +1,85 @@
+// Checks UnrolledList insertions whose argument is an element of the list
+// itself, as std::list allows. Exits non-zero on failure.
+//
+//   g++ -std=c++17 -O2 -I. bench/unrolled_list_test.cpp -o unrolled_list_test
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <string>
+
+#include "bench_util.h"
+#include "unrolled_list.h"
+
+namespace {
+
+using List = UnrolledList<std::string>;
+
+// Strings long enough to own a heap buffer, so a moved-from source is empty.
+std::string Value(int i) { return "element number " + std::to_string(i) + " of the list"; }
+
+void Fill(List& list, std::list<std::string>& expected, int count) {
+  for (int i = 0; i < count; ++i) {
+    list.push_back(Value(i));
+    expected.push_back(Value(i));
+  }
+}
+
+void CheckList(const char* name, const List& actual, const std::list<std::string>& expected) {
+  Check(name, actual.size() == expected.size() &&
+                  std::equal(actual.begin(), actual.end(), expected.begin()));
+}
+
+}  // namespace
+
+int main() {
+  {
+    List list;
+    std::list<std::string> expected;
+    Fill(list, expected, 5);
+    // Leaves room in the head node, so the front element shifts up.
+    list.pop_front();
+    expected.pop_front();
+    list.push_front(list.front());
+    expected.push_front(expected.front());
+    CheckList("push_front of the front element", list, expected);
+  }
+  {
+    List list;
+    std::list<std::string> expected;
+    Fill(list, expected, 4);
+    list.push_back(list.back());
+    expected.push_back(expected.back());
+    CheckList("push_back of the back element", list, expected);
+  }
+  {
+    List list;
+    std::list<std::string> expected;
+    Fill(list, expected, 8);
+    for (int i = 0; i < 8; ++i) {
+      auto at = std::next(list.begin(), i);
+      list.insert(at, *at);
+      auto expected_at = std::next(expected.begin(), i);
+      expected.insert(expected_at, *expected_at);
+    }
+    CheckList("insert of the element at the position", list, expected);
+  }
+  {
+    List list;
+    std::list<std::string> expected;
+    Fill(list, expected, 7);
+    list.insert(std::next(list.begin()), *std::next(list.begin(), 5));
+    expected.insert(std::next(expected.begin()), *std::next(expected.begin(), 5));
+    CheckList("insert of an element from another node", list, expected);
+  }
+  {
+    List list;
+    std::list<std::string> expected;
+    Fill(list, expected, 6);
+    list.pop_front();
+    expected.pop_front();
+    list.emplace(list.begin(), list.front(), 8);
+    expected.emplace(expected.begin(), expected.front(), 8);
+    CheckList("emplace from a prefix of an element", list, expected);
+  }
+  return TestExitCode();
+}
@@ -0,0 +1,406 @@
+#pragma once
+#include <fcntl.h>
+#include <linux/userfaultfd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// Experimental, Linux-only pool that compresses cold slabs in place. Slabs are
+// carved out of one reserved address range registered with userfaultfd.
+// compress_idle() run-length encodes every slab that has stayed idle for
+// enough passes into a heap-side store and drops its pages; the first access
+// to a dropped page faults into a handler thread that decompresses the whole
+// slab back into place. Pointers into the pool therefore stay valid while cold
+// slabs cost only their compressed size.
+//
+// Reads of resident slabs are invisible to the pool, so a slab counts as
+// accessed when it allocates, deallocates or faults back in, and every
+// refault doubles the number of idle passes the slab needs before it is
+// compressed again. No thread may write to the pool while compress_idle()
+// runs. The userfaultfd is opened for user-mode faults only where the kernel
+// supports it, so system calls given pointers into a compressed slab fail
+// with EFAULT instead of decompressing it. Like PoolAllocator, the pool is
+// otherwise not thread-safe.
+template <typename T, size_t kSlabBytes = 65536>
+class ColdSlabPool {
+  static_assert(kSlabBytes % 4096 == 0, "Slab size must be a multiple of the page size");
+
+ private:
+  union Chunk {
+    Chunk* next;
+    alignas(T) char data[sizeof(T)];
+  };
+
+  static constexpr size_t kChunksPerSlab = kSlabBytes / sizeof(Chunk);
+  static_assert(kChunksPerSlab > 0, "Slab too small for one object");
+  static constexpr uint32_t kMaxIdlePasses = 64;
+
+  struct Slab {
+    // Owned by the pool's thread.
+    Chunk* free_list = nullptr;
+    size_t live = 0;
+    size_t bumped = 0;
+    uint32_t idle = 0;
+    bool accessed = true;
+    bool open = true;
+    // Shared with the fault handler; guarded by mutex_.
+    bool compressed = false;
+    bool refaulted = false;
+    uint32_t required = 1;
+    std::vector<unsigned char> store;
+  };
+
+ public:
+  using value_type = T;
+
+  // Reserves `max_bytes` of address space for slabs. A slab must stay idle
+  // for `idle_passes` calls to compress_idle() before it is compressed.
+  // Throws std::system_error when userfaultfd is unavailable.
+  explicit ColdSlabPool(size_t max_bytes = size_t{1} << 32, uint32_t idle_passes = 2)
+      : max_slabs_(max_bytes / kSlabBytes), idle_passes_(std::max<uint32_t>(idle_passes, 1)) {
+    try {
+      Open();
+    } catch (...) {
+      Close();
+      throw;
+    }
+    scratch_.resize(kSlabBytes + kSlabBytes / 128 + 1);
+    handler_ = std::thread([this] { HandleFaults(); });
+  }
+
+  ColdSlabPool(const ColdSlabPool&) = delete;
+  ColdSlabPool& operator=(const ColdSlabPool&) = delete;
+
+  // Releases the whole range. Objects still allocated become dangling.
+  ~ColdSlabPool() noexcept {
+    uint64_t one = 1;
+    while (write(stop_fd_, &one, sizeof(one)) < 0 && errno == EINTR) {
+    }
+    handler_.join();
+    Close();
+  }
+
+  // Returns uninitialized storage for one T.
+  [[nodiscard]] T* allocate() {
+    while (!open_.empty() && slabs_[open_.back()].live == kChunksPerSlab) {
+      slabs_[open_.back()].open = false;
+      open_.pop_back();
+    }
+    size_t index = open_.empty() ? NewSlab() : open_.back();
+    Slab& slab = slabs_[index];
+    Chunk* chunk = slab.free_list;
+    if (chunk) {
+      slab.free_list = chunk->next;
+    } else {
+      chunk = ChunkAt(index, slab.bumped++);
+    }
+    ++slab.live;
+    ++live_;
+    slab.accessed = true;
+    return std::launder(reinterpret_cast<T*>(chunk->data));
+  }
+
+  void deallocate(T* p) noexcept {
+    if (!p) return;
+    Chunk* chunk = std::launder(reinterpret_cast<Chunk*>(p));
+    size_t index = static_cast<size_t>(reinterpret_cast<char*>(chunk) - base_) / kSlabBytes;
+    Slab& slab = slabs_[index];
+    chunk->next = slab.free_list;
+    slab.free_list = chunk;
+    --slab.live;
+    --live_;
+    slab.accessed = true;
+    if (!slab.open) {
+      slab.open = true;
+      open_.push_back(index);
+    }
+  }
+
+  // Compresses every resident slab that has been idle for its required
+  // number of passes and returns how many it compressed. Empty slabs are
+  // dropped without a store and come back zero-filled.
+  size_t compress_idle() {
+    size_t compressed = 0;
+    for (size_t index = 0; index < slabs_.size(); ++index) {
+      Slab& slab = slabs_[index];
+      bool refaulted;
+      uint32_t required;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (slab.compressed) continue;
+        refaulted = slab.refaulted;
+        slab.refaulted = false;
+        required = slab.required;
+      }
+      if (slab.accessed || refaulted) {
+        slab.accessed = false;
+        slab.idle = 0;
+        continue;
+      }
+      if (++slab.idle < required) continue;
+      std::vector<unsigned char> store;
+      if (slab.live == 0) {
+        slab.free_list = nullptr;
+        slab.bumped = 0;
+      } else {
+        size_t size = Compress(SlabAt(index), scratch_.data());
+        // Not worth it: try again after another full idle period.
+        if (size > kSlabBytes - kSlabBytes / 8) {
+          slab.idle = 0;
+          continue;
+        }
+        store.assign(scratch_.data(), scratch_.data() + size);
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        compressed_bytes_ += store.size();
+        slab.store = std::move(store);
+        slab.compressed = true;
+      }
+      madvise(SlabAt(index), kSlabBytes, MADV_DONTNEED);
+      slab.idle = 0;
+      ++compressed;
+    }
+    return compressed;
+  }
+
+  [[nodiscard]] size_t live() const noexcept { return live_; }
+  [[nodiscard]] size_t slab_count() const noexcept { return slabs_.size(); }
+
+  [[nodiscard]] size_t compressed_slab_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (const Slab& slab : slabs_) count += slab.compressed;
+    return count;
+  }
+
+  // Bytes held by the compressed store.
+  [[nodiscard]] size_t compressed_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return compressed_bytes_;
+  }
+
+  // Slabs decompressed by the fault handler so far.
+  [[nodiscard]] size_t fault_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return faults_;
+  }
+
+  // Bytes of slab memory currently backed by RAM, measured with mincore().
+  [[nodiscard]] size_t resident_bytes() const {
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t length = slabs_.size() * kSlabBytes;
+    std::vector<unsigned char> pages((length + page - 1) / page);
+    if (length == 0 || mincore(base_, length, pages.data()) != 0) return 0;
+    size_t resident = 0;
+    for (unsigned char state : pages) resident += state & 1;
+    return resident * page;
+  }
+
+ private:
+  char* SlabAt(size_t index) const noexcept { return base_ + index * kSlabBytes; }
+
+  Chunk* ChunkAt(size_t index, size_t chunk) const noexcept {
+    return reinterpret_cast<Chunk*>(SlabAt(index)) + chunk;
+  }
+
+  void Open() {
+    if (max_slabs_ == 0) {
+      throw std::system_error(EINVAL, std::system_category(), "ColdSlabPool: max_bytes");
+    }
+    void* memory = mmap(nullptr, max_slabs_ * kSlabBytes, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (memory == MAP_FAILED) Fail("mmap");
+    base_ = static_cast<char*>(memory);
+    uffd_ = static_cast<int>(
+        syscall(SYS_userfaultfd, O_CLOEXEC | O_NONBLOCK | UFFD_USER_MODE_ONLY));
+    if (uffd_ < 0 && errno == EINVAL) {
+      uffd_ = static_cast<int>(syscall(SYS_userfaultfd, O_CLOEXEC | O_NONBLOCK));
+    }
+    if (uffd_ < 0) Fail("userfaultfd");
+    uffdio_api api{};
+    api.api = UFFD_API;
+    if (ioctl(uffd_, UFFDIO_API, &api) != 0) Fail("UFFDIO_API");
+    uffdio_register reg{};
+    reg.range.start = reinterpret_cast<uintptr_t>(base_);
+    reg.range.len = max_slabs_ * kSlabBytes;
+    reg.mode = UFFDIO_REGISTER_MODE_MISSING;
+    if (ioctl(uffd_, UFFDIO_REGISTER, &reg) != 0) Fail("UFFDIO_REGISTER");
+    stop_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (stop_fd_ < 0) Fail("eventfd");
+  }
+
+  void Close() noexcept {
+    if (stop_fd_ >= 0) close(stop_fd_);
+    if (uffd_ >= 0) close(uffd_);
+    if (base_) munmap(base_, max_slabs_ * kSlabBytes);
+  }
+
+  [[noreturn]] static void Fail(const char* call) {
+    int error = errno;
+    std::cerr << "ColdSlabPool: " << call << " failed: " << std::strerror(error) << "\n";
+    throw std::system_error(error, std::system_category(), call);
+  }
+
+  // Maps zero pages over a new slab so that first-touch faults never reach
+  // the handler.
+  size_t NewSlab() {
+    if (slabs_.size() == max_slabs_) {
+      std::cerr << "ColdSlabPool::allocate: Reserved range exhausted\n";
+      throw std::bad_alloc();
+    }
+    size_t index = slabs_.size();
+    open_.reserve(open_.size() + 1);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      slabs_.emplace_back();
+      slabs_.back().required = idle_passes_;
+    }
+    ZeroFill(SlabAt(index), kSlabBytes);
+    open_.push_back(index);
+    return index;
+  }
+
+  void ZeroFill(char* start, size_t length) noexcept {
+    uffdio_zeropage zero{};
+    zero.range.start = reinterpret_cast<uintptr_t>(start);
+    zero.range.len = length;
+    if (ioctl(uffd_, UFFDIO_ZEROPAGE, &zero) != 0 && errno != EEXIST) Abort("UFFDIO_ZEROPAGE");
+  }
+
+  void Wake(char* start, size_t length) noexcept {
+    uffdio_range range{};
+    range.start = reinterpret_cast<uintptr_t>(start);
+    range.len = length;
+    ioctl(uffd_, UFFDIO_WAKE, &range);
+  }
+
+  // A failure here would leave the faulting thread blocked forever.
+  [[noreturn]] static void Abort(const char* call) noexcept {
+    std::cerr << "ColdSlabPool: " << call << " failed: " << std::strerror(errno) << "\n";
+    std::abort();
+  }
+
+  void HandleFaults() noexcept {
+    pollfd fds[2] = {{uffd_, POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+    std::vector<unsigned char> slab(kSlabBytes);
+    for (;;) {
+      if (poll(fds, 2, -1) < 0) continue;
+      if (fds[1].revents) return;
+      uffd_msg message;
+      if (read(uffd_, &message, sizeof(message)) != sizeof(message)) continue;
+      if (message.event != UFFD_EVENT_PAGEFAULT) continue;
+      Restore(static_cast<uintptr_t>(message.arg.pagefault.address), slab.data());
+    }
+  }
+
+  // Decompresses the slab containing `address` into place, which also wakes
+  // every thread faulting on it.
+  void Restore(uintptr_t address, unsigned char* buffer) noexcept {
+    size_t offset = address - reinterpret_cast<uintptr_t>(base_);
+    size_t index = offset / kSlabBytes;
+    std::lock_guard<std::mutex> lock(mutex_);
+    // A stray access beyond the last slab gets a zero page rather than a hang.
+    if (index >= slabs_.size()) {
+      ZeroFill(base_ + offset / 4096 * 4096, 4096);
+      return;
+    }
+    Slab& slab = slabs_[index];
+    if (!slab.compressed) {
+      Wake(SlabAt(index), kSlabBytes);
+      return;
+    }
+    if (slab.store.empty()) {
+      ZeroFill(SlabAt(index), kSlabBytes);
+    } else {
+      Decompress(slab.store.data(), slab.store.size(), buffer);
+      uffdio_copy copy{};
+      copy.dst = reinterpret_cast<uintptr_t>(SlabAt(index));
+      copy.src = reinterpret_cast<uintptr_t>(buffer);
+      copy.len = kSlabBytes;
+      if (ioctl(uffd_, UFFDIO_COPY, &copy) != 0) {
+        if (errno != EEXIST) Abort("UFFDIO_COPY");
+        Wake(SlabAt(index), kSlabBytes);
+      }
+    }
+    compressed_bytes_ -= slab.store.size();
+    std::vector<unsigned char>().swap(slab.store);
+    slab.compressed = false;
+    slab.refaulted = true;
+    slab.required = std::min(slab.required * 2, kMaxIdlePasses);
+    ++faults_;
+  }
+
+  // PackBits-style run-length coding: a control byte c < 128 is followed by
+  // c + 1 literal bytes, c >= 128 by one byte repeated c - 125 times.
+  static size_t Compress(const char* source, unsigned char* out) noexcept {
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(source);
+    size_t size = 0;
+    size_t i = 0;
+    while (i < kSlabBytes) {
+      size_t run = 1;
+      while (i + run < kSlabBytes && run < 130 && in[i + run] == in[i]) ++run;
+      if (run >= 3) {
+        out[size++] = static_cast<unsigned char>(run + 125);
+        out[size++] = in[i];
+        i += run;
+        continue;
+      }
+      size_t start = i;
+      size_t count = 0;
+      while (i < kSlabBytes && count < 128) {
+        if (i + 2 < kSlabBytes && in[i] == in[i + 1] && in[i] == in[i + 2]) break;
+        ++i;
+        ++count;
+      }
+      out[size++] = static_cast<unsigned char>(count - 1);
+      std::memcpy(out + size, in + start, count);
+      size += count;
+    }
+    return size;
+  }
+
+  static void Decompress(const unsigned char* in, size_t size, unsigned char* out) noexcept {
+    for (size_t i = 0; i < size;) {
+      unsigned char control = in[i++];
+      if (control < 128) {
+        std::memcpy(out, in + i, control + 1u);
+        out += control + 1u;
+        i += control + 1u;
+      } else {
+        std::memset(out, in[i++], control - 125u);
+        out += control - 125u;
+      }
+    }
+  }
+
+  size_t max_slabs_;
+  uint32_t idle_passes_;
+  char* base_ = nullptr;
+  int uffd_ = -1;
+  int stop_fd_ = -1;
+  size_t live_ = 0;
+  std::vector<Slab> slabs_;
+  std::vector<size_t> open_;
+  std::vector<unsigned char> scratch_;
+  mutable std::mutex mutex_;
+  size_t compressed_bytes_ = 0;
+  size_t faults_ = 0;
+  std::thread handler_;
+};
@@ -0,0 +1,250 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <new>
+
+#include "concurrent_pool.h"
+
+// Lock-free hash map built on a split-ordered list (Shalev and Shavit): all
+// entries live in one Harris-Michael sorted list ordered by bit-reversed hash,
+// and buckets are lazily inserted dummy nodes pointing into it, so doubling
+// the table never moves an entry. Entry nodes come from a ConcurrentPool and
+// are reclaimed through its epochs; values are immutable once inserted.
+template <typename K, typename V, typename Hash = std::hash<K>,
+          typename KeyEqual = std::equal_to<K>, size_t kBlockSize = 1024>
+class ConcurrentHashMap {
+ private:
+  static constexpr uintptr_t kMark = 1;
+  static constexpr uint64_t kHashMask = ~uint64_t{0} >> 1;
+  static constexpr size_t kSegments = 64;
+  static constexpr size_t kMaxLoad = 2;
+
+  // Bucket dummies carry an even split-order key, entries an odd one.
+  struct NodeBase {
+    std::atomic<uintptr_t> next{0};
+    uint64_t so_key;
+
+    explicit NodeBase(uint64_t key) noexcept : so_key(key) {}
+  };
+
+  struct Node : NodeBase {
+    K key;
+    V value;
+
+    Node(uint64_t so_key, const K& k, const V& v) : NodeBase(so_key), key(k), value(v) {}
+  };
+
+  using Bucket = std::atomic<NodeBase*>;
+
+  ConcurrentPool<Node, kBlockSize> nodes_;
+  ConcurrentPool<NodeBase, kBlockSize> dummies_;
+  // Segment 0 holds buckets 0 and 1; segment s > 0 holds [2^s, 2^(s+1)).
+  std::atomic<Bucket*> segments_[kSegments] = {};
+  std::atomic<size_t> bucket_count_{2};
+  std::atomic<size_t> size_{0};
+  NodeBase* head_;
+
+ public:
+  using key_type = K;
+  using mapped_type = V;
+  using size_type = size_t;
+
+  ConcurrentHashMap() {
+    head_ = new (dummies_.allocate()) NodeBase(0);
+    Segment(0)[0].store(head_, std::memory_order_release);
+  }
+
+  ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+  ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+
+  // Not thread-safe: no other thread may be using the map.
+  ~ConcurrentHashMap() noexcept {
+    for (NodeBase* node = head_; node;) {
+      NodeBase* next = Ptr(node->next.load(std::memory_order_relaxed));
+      if (node->so_key & 1) {
+        nodes_.destroy(static_cast<Node*>(node));
+      } else {
+        dummies_.destroy(node);
+      }
+      node = next;
+    }
+    for (auto& segment : segments_) {
+      delete[] segment.load(std::memory_order_relaxed);
+    }
+  }
+
+  [[nodiscard]] size_t size() const noexcept { return size_.load(std::memory_order_relaxed); }
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+  // Inserts `key` -> `value` unless `key` is present. Returns whether it
+  // inserted.
+  bool insert(const K& key, const V& value) {
+    typename ConcurrentPool<Node, kBlockSize>::Guard guard(nodes_);
+    uint64_t hash = Hash{}(key) & kHashMask;
+    NodeBase* head = GetBucket(hash % bucket_count_.load(std::memory_order_acquire));
+    Node* node = new (nodes_.allocate()) Node(RegularKey(hash), key, value);
+    NodeBase* prev;
+    NodeBase* curr;
+    for (;;) {
+      if (Find(head, node->so_key, &key, prev, curr)) {
+        nodes_.destroy(node);
+        return false;
+      }
+      node->next.store(reinterpret_cast<uintptr_t>(curr), std::memory_order_relaxed);
+      uintptr_t expected = reinterpret_cast<uintptr_t>(curr);
+      if (prev->next.compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(node),
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+        break;
+      }
+    }
+    size_t buckets = bucket_count_.load(std::memory_order_relaxed);
+    if (size_.fetch_add(1, std::memory_order_relaxed) + 1 > buckets * kMaxLoad &&
+        buckets < (size_t{1} << (kSegments - 1))) {
+      bucket_count_.compare_exchange_strong(buckets, buckets * 2, std::memory_order_release,
+                                            std::memory_order_relaxed);
+    }
+    return true;
+  }
+
+  // Copies the value stored under `key` into `out`. Returns whether found.
+  bool find(const K& key, V& out) {
+    typename ConcurrentPool<Node, kBlockSize>::Guard guard(nodes_);
+    uint64_t hash = Hash{}(key) & kHashMask;
+    NodeBase* head = GetBucket(hash % bucket_count_.load(std::memory_order_acquire));
+    NodeBase* prev;
+    NodeBase* curr;
+    if (!Find(head, RegularKey(hash), &key, prev, curr)) return false;
+    out = static_cast<Node*>(curr)->value;
+    return true;
+  }
+
+  bool contains(const K& key) {
+    V value;
+    return find(key, value);
+  }
+
+  // Removes `key`. Returns whether this call removed it.
+  bool erase(const K& key) {
+    typename ConcurrentPool<Node, kBlockSize>::Guard guard(nodes_);
+    uint64_t hash = Hash{}(key) & kHashMask;
+    uint64_t so_key = RegularKey(hash);
+    NodeBase* head = GetBucket(hash % bucket_count_.load(std::memory_order_acquire));
+    NodeBase* prev;
+    NodeBase* curr;
+    for (;;) {
+      if (!Find(head, so_key, &key, prev, curr)) return false;
+      uintptr_t next = curr->next.load(std::memory_order_acquire);
+      if (next & kMark) continue;
+      if (!curr->next.compare_exchange_strong(next, next | kMark, std::memory_order_acq_rel,
+                                              std::memory_order_relaxed)) {
+        continue;
+      }
+      uintptr_t expected = reinterpret_cast<uintptr_t>(curr);
+      if (prev->next.compare_exchange_strong(expected, next, std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+        nodes_.retire(static_cast<Node*>(curr));
+      } else {
+        Find(head, so_key, &key, prev, curr);
+      }
+      size_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+
+ private:
+  static NodeBase* Ptr(uintptr_t link) noexcept {
+    return reinterpret_cast<NodeBase*>(link & ~kMark);
+  }
+
+  static uint64_t Reverse(uint64_t x) noexcept {
+    x = ((x >> 1) & 0x5555555555555555ull) | ((x & 0x5555555555555555ull) << 1);
+    x = ((x >> 2) & 0x3333333333333333ull) | ((x & 0x3333333333333333ull) << 2);
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((x & 0x0F0F0F0F0F0F0F0Full) << 4);
+    return __builtin_bswap64(x);
+  }
+
+  static uint64_t RegularKey(uint64_t hash) noexcept { return Reverse(hash | ~kHashMask); }
+  static uint64_t DummyKey(uint64_t bucket) noexcept { return Reverse(bucket); }
+
+  Bucket* Segment(size_t index) {
+    Bucket* segment = segments_[index].load(std::memory_order_acquire);
+    if (segment) return segment;
+    size_t count = index == 0 ? 2 : size_t{1} << index;
+    Bucket* fresh = new Bucket[count]();
+    if (segments_[index].compare_exchange_strong(segment, fresh, std::memory_order_acq_rel)) {
+      return fresh;
+    }
+    delete[] fresh;
+    return segment;
+  }
+
+  Bucket& BucketSlot(size_t bucket) {
+    if (bucket < 2) return Segment(0)[bucket];
+    size_t index = 63 - static_cast<size_t>(__builtin_clzll(bucket));
+    return Segment(index)[bucket - (size_t{1} << index)];
+  }
+
+  // Returns the dummy node of `bucket`, splicing it in after its parent
+  // bucket's dummy first if needed.
+  NodeBase* GetBucket(size_t bucket) {
+    Bucket& slot = BucketSlot(bucket);
+    NodeBase* dummy = slot.load(std::memory_order_acquire);
+    if (dummy) return dummy;
+    size_t parent = bucket & ~(size_t{1} << (63 - __builtin_clzll(bucket)));
+    NodeBase* parent_dummy = GetBucket(parent);
+    NodeBase* fresh = new (dummies_.allocate()) NodeBase(DummyKey(bucket));
+    NodeBase* prev;
+    NodeBase* curr;
+    for (;;) {
+      if (Find(parent_dummy, fresh->so_key, nullptr, prev, curr)) {
+        dummies_.destroy(fresh);
+        dummy = curr;
+        break;
+      }
+      fresh->next.store(reinterpret_cast<uintptr_t>(curr), std::memory_order_relaxed);
+      uintptr_t expected = reinterpret_cast<uintptr_t>(curr);
+      if (prev->next.compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(fresh),
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+        dummy = fresh;
+        break;
+      }
+    }
+    slot.store(dummy, std::memory_order_release);
+    return dummy;
+  }
+
+  // Harris-Michael search from `head` for the node with split-order key
+  // `so_key` (and `*key`, for entries). Leaves `prev`/`curr` around the
+  // position, unlinking and retiring marked nodes on the way.
+  bool Find(NodeBase* head, uint64_t so_key, const K* key, NodeBase*& prev, NodeBase*& curr) {
+  retry:
+    prev = head;
+    curr = Ptr(prev->next.load(std::memory_order_acquire));
+    for (;;) {
+      if (!curr) return false;
+      uintptr_t next = curr->next.load(std::memory_order_acquire);
+      if (next & kMark) {
+        uintptr_t expected = reinterpret_cast<uintptr_t>(curr);
+        if (!prev->next.compare_exchange_strong(expected, next & ~kMark,
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_relaxed)) {
+          goto retry;
+        }
+        nodes_.retire(static_cast<Node*>(curr));
+        curr = Ptr(next);
+        continue;
+      }
+      if (curr->so_key > so_key) return false;
+      if (curr->so_key == so_key &&
+          (!key || KeyEqual{}(static_cast<Node*>(curr)->key, *key))) {
+        return true;
+      }
+      prev = curr;
+      curr = Ptr(next);
+    }
+  }
+};
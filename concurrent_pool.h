@@ -0,0 +1,261 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <new>
+
+// Small per-thread index, recycled when the thread exits. ConcurrentPool uses
+// it to give each thread a private slot without locking.
+class PoolThreadIndex {
+ public:
+  static constexpr size_t kMaxThreads = 128;
+
+  static size_t Get() {
+    thread_local Holder holder;
+    return holder.index;
+  }
+
+ private:
+  struct Holder {
+    size_t index;
+    Holder() : index(Acquire()) {}
+    ~Holder() { Used()[index].store(false, std::memory_order_release); }
+  };
+
+  static std::atomic<bool>* Used() {
+    static std::atomic<bool> used[kMaxThreads];
+    return used;
+  }
+
+  static size_t Acquire() {
+    for (size_t i = 0; i < kMaxThreads; ++i) {
+      bool expected = false;
+      if (Used()[i].compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+        return i;
+      }
+    }
+    std::cerr << "PoolThreadIndex: More than " << kMaxThreads << " concurrent threads\n";
+    throw std::bad_alloc();
+  }
+};
+
+// Thread-safe pool of T-sized chunks with epoch-based reclamation. Each
+// thread allocates from and frees into its own slot, so the fast paths touch
+// no shared atomics. Objects that other threads may still be reading are
+// retire()d inside a Guard and only destroyed and reused once every thread
+// has left the epoch in which they were retired. A thread whose free list
+// grows past two blocks (because it frees what others allocate) hands a block's
+// worth of chunks to a shared overflow list, which threads drain before
+// carving new slabs.
+template <typename T, size_t kBlockSize = 1024>
+class ConcurrentPool {
+ private:
+  // The link sits outside the object so that retiring never writes to memory
+  // concurrent readers may still be traversing.
+  struct Chunk {
+    Chunk* next;
+    alignas(T) char data[sizeof(T)];
+  };
+
+  struct Slab {
+    Slab* next;
+  };
+
+  static constexpr size_t kEpochLists = 3;
+  static constexpr size_t kAdvanceInterval = 64;
+  static constexpr size_t kFreeLimit = 2 * kBlockSize;
+  static constexpr size_t kSlabHeader =
+      ((sizeof(Slab) + alignof(Chunk) - 1) / alignof(Chunk)) * alignof(Chunk);
+
+  // Announced epoch, shifted left by one, with the low bit set while the
+  // owning thread is inside a Guard.
+  struct alignas(64) ThreadSlot {
+    std::atomic<uint64_t> state{0};
+    Chunk* free_list = nullptr;
+    size_t free_count = 0;
+    Chunk* retired[kEpochLists] = {};
+    uint64_t retired_epoch[kEpochLists] = {};
+    size_t retired_count = 0;
+  };
+
+  std::atomic<uint64_t> global_epoch_{kEpochLists};
+  std::atomic<Slab*> slabs_{nullptr};
+  // Batches of free chunks handed over by threads with surplus. Only ever
+  // pushed onto or emptied as a whole, so it needs no ABA protection.
+  std::atomic<Chunk*> overflow_{nullptr};
+  ThreadSlot slots_[PoolThreadIndex::kMaxThreads];
+
+ public:
+  // Marks the calling thread as reading shared objects from this pool.
+  class Guard {
+   public:
+    explicit Guard(ConcurrentPool& pool) : pool_(pool), slot_(pool.Slot()) {
+      uint64_t epoch = pool_.global_epoch_.load(std::memory_order_acquire);
+      slot_.state.exchange((epoch << 1) | 1, std::memory_order_seq_cst);
+      pool_.Reclaim(slot_, epoch);
+    }
+
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+
+    ~Guard() { slot_.state.store(0, std::memory_order_release); }
+
+   private:
+    ConcurrentPool& pool_;
+    ThreadSlot& slot_;
+  };
+
+  ConcurrentPool() = default;
+  ConcurrentPool(const ConcurrentPool&) = delete;
+  ConcurrentPool& operator=(const ConcurrentPool&) = delete;
+
+  // Destroys retired objects and frees every slab. Live objects must already
+  // have been destroyed, and no thread may still be using the pool.
+  ~ConcurrentPool() noexcept {
+    for (ThreadSlot& slot : slots_) {
+      for (Chunk*& list : slot.retired) {
+        DestroyList(list);
+      }
+    }
+    for (Slab* slab = slabs_.load(std::memory_order_acquire); slab;) {
+      Slab* next = slab->next;
+      ::operator delete(slab, std::align_val_t{alignof(Chunk)});
+      slab = next;
+    }
+  }
+
+  // Returns uninitialized storage for one T.
+  [[nodiscard]] T* allocate() {
+    ThreadSlot& slot = Slot();
+    if (!slot.free_list) {
+      Carve(slot);
+    }
+    Chunk* chunk = slot.free_list;
+    slot.free_list = chunk->next;
+    --slot.free_count;
+    return std::launder(reinterpret_cast<T*>(chunk->data));
+  }
+
+  // Destroys `p` and recycles it immediately. Only valid for objects no other
+  // thread can reach.
+  void destroy(T* p) noexcept {
+    p->~T();
+    ThreadSlot& slot = Slot();
+    Push(slot.free_list, p);
+    if (++slot.free_count > kFreeLimit) HandOff(slot);
+  }
+
+  // Schedules `p` for destruction once no Guard that could have seen it is
+  // still open. The caller must hold a Guard. The object is tagged with the
+  // global epoch rather than the caller's, which may already be behind.
+  void retire(T* p) noexcept {
+    ThreadSlot& slot = Slot();
+    uint64_t epoch = global_epoch_.load(std::memory_order_acquire);
+    size_t index = epoch % kEpochLists;
+    if (slot.retired_epoch[index] != epoch) {
+      RecycleList(slot, index);
+      slot.retired_epoch[index] = epoch;
+    }
+    Push(slot.retired[index], p);
+    if (++slot.retired_count % kAdvanceInterval == 0) {
+      TryAdvance();
+    }
+  }
+
+ private:
+  ThreadSlot& Slot() { return slots_[PoolThreadIndex::Get()]; }
+
+  static void Push(Chunk*& list, T* p) noexcept {
+    Chunk* chunk = reinterpret_cast<Chunk*>(reinterpret_cast<char*>(p) - offsetof(Chunk, data));
+    chunk->next = list;
+    list = chunk;
+  }
+
+  static void DestroyList(Chunk*& list) noexcept {
+    for (Chunk* chunk = list; chunk;) {
+      Chunk* next = chunk->next;
+      std::launder(reinterpret_cast<T*>(chunk->data))->~T();
+      chunk = next;
+    }
+    list = nullptr;
+  }
+
+  // Destroys the objects retired into list `index` and moves them to the
+  // free list.
+  void RecycleList(ThreadSlot& slot, size_t index) noexcept {
+    Chunk* chunk = slot.retired[index];
+    while (chunk) {
+      Chunk* next = chunk->next;
+      std::launder(reinterpret_cast<T*>(chunk->data))->~T();
+      chunk->next = slot.free_list;
+      slot.free_list = chunk;
+      ++slot.free_count;
+      chunk = next;
+    }
+    slot.retired[index] = nullptr;
+    while (slot.free_count > kFreeLimit) HandOff(slot);
+  }
+
+  // Moves kBlockSize chunks from the front of the slot's free list to the
+  // overflow list.
+  void HandOff(ThreadSlot& slot) noexcept {
+    Chunk* first = slot.free_list;
+    Chunk* last = first;
+    for (size_t i = 1; i < kBlockSize; ++i) last = last->next;
+    slot.free_list = last->next;
+    slot.free_count -= kBlockSize;
+    last->next = overflow_.load(std::memory_order_relaxed);
+    while (!overflow_.compare_exchange_weak(last->next, first, std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+    }
+  }
+
+  // Objects retired two epochs before `epoch` can no longer be referenced:
+  // every Guard open during their epoch has since closed.
+  void Reclaim(ThreadSlot& slot, uint64_t epoch) noexcept {
+    for (size_t i = 0; i < kEpochLists; ++i) {
+      if (slot.retired[i] && slot.retired_epoch[i] + 2 <= epoch) {
+        RecycleList(slot, i);
+      }
+    }
+  }
+
+  void TryAdvance() noexcept {
+    uint64_t epoch = global_epoch_.load(std::memory_order_acquire);
+    for (const ThreadSlot& slot : slots_) {
+      uint64_t state = slot.state.load(std::memory_order_seq_cst);
+      if ((state & 1) && (state >> 1) != epoch) return;
+    }
+    global_epoch_.compare_exchange_strong(epoch, epoch + 1, std::memory_order_acq_rel);
+  }
+
+  // Refills an empty free list from the overflow list, or from a new slab
+  // when that is empty too.
+  void Carve(ThreadSlot& slot) {
+    if (Chunk* chunks = overflow_.exchange(nullptr, std::memory_order_acquire)) {
+      slot.free_list = chunks;
+      for (; chunks; chunks = chunks->next) ++slot.free_count;
+      return;
+    }
+    void* memory;
+    try {
+      memory = ::operator new(kSlabHeader + kBlockSize * sizeof(Chunk),
+                              std::align_val_t{alignof(Chunk)});
+    } catch (const std::bad_alloc& e) {
+      std::cerr << "ConcurrentPool::allocate: Memory allocation failed: " << e.what() << "\n";
+      throw;
+    }
+    Slab* slab = static_cast<Slab*>(memory);
+    slab->next = slabs_.load(std::memory_order_relaxed);
+    while (!slabs_.compare_exchange_weak(slab->next, slab, std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+    }
+    Chunk* chunks = reinterpret_cast<Chunk*>(static_cast<char*>(memory) + kSlabHeader);
+    for (size_t i = kBlockSize; i-- > 0;) {
+      chunks[i].next = slot.free_list;
+      slot.free_list = &chunks[i];
+    }
+    slot.free_count += kBlockSize;
+  }
+};
@@ -0,0 +1,179 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "concurrent_pool.h"
+
+// Thread-safe hash-consing pool for immutable values. intern() returns the
+// pooled instance equal to its argument, creating it on first use, so equal
+// values share one chunk and compare equal by pointer. Instances are
+// refcounted: every intern() and retain() must be matched by a release(), and
+// the last release destroys the instance and returns its chunk to the
+// underlying ConcurrentPool. The index is split into lock-striped chained
+// hash tables whose chains run through the pooled nodes themselves.
+template <typename T, typename Hash = std::hash<T>, typename KeyEqual = std::equal_to<T>,
+          size_t kBlockSize = 1024>
+class HashConsPool {
+ private:
+  struct Node {
+    Node* next;
+    size_t hash;
+    std::atomic<size_t> refs;
+    alignas(T) char data[sizeof(T)];
+
+    const T& value() const noexcept { return *std::launder(reinterpret_cast<const T*>(data)); }
+  };
+
+  static constexpr size_t kStripes = 64;
+  static constexpr size_t kMinBuckets = 16;
+  static constexpr size_t kMaxLoad = 1;
+
+  struct alignas(64) Stripe {
+    std::mutex mutex;
+    std::vector<Node*> buckets;
+    size_t size = 0;
+  };
+
+  ConcurrentPool<Node, kBlockSize> nodes_;
+  Stripe stripes_[kStripes];
+
+ public:
+  using value_type = T;
+
+  HashConsPool() = default;
+  HashConsPool(const HashConsPool&) = delete;
+  HashConsPool& operator=(const HashConsPool&) = delete;
+
+  // Destroys every instance still interned. No thread may be using the pool.
+  ~HashConsPool() noexcept {
+    for (Stripe& stripe : stripes_) {
+      for (Node* node : stripe.buckets) {
+        while (node) {
+          Node* next = node->next;
+          Destroy(node);
+          node = next;
+        }
+      }
+    }
+  }
+
+  // Returns the pooled instance equal to `value` with one more reference.
+  const T* intern(const T& value) { return Intern(value); }
+  const T* intern(T&& value) { return Intern(std::move(value)); }
+
+  // Adds a reference to an interned instance.
+  void retain(const T* p) noexcept { NodeOf(p)->refs.fetch_add(1, std::memory_order_relaxed); }
+
+  // Drops a reference; the last one destroys the instance. References above
+  // one are dropped without locking, and the last one is dropped under the
+  // stripe lock so that a concurrent intern() cannot revive it mid-removal.
+  void release(const T* p) noexcept {
+    Node* node = NodeOf(p);
+    size_t refs = node->refs.load(std::memory_order_relaxed);
+    while (refs > 1) {
+      if (node->refs.compare_exchange_weak(refs, refs - 1, std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+        return;
+      }
+    }
+    Stripe& stripe = StripeOf(node->hash);
+    {
+      std::lock_guard<std::mutex> lock(stripe.mutex);
+      if (node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+      Node** link = &stripe.buckets[BucketOf(stripe, node->hash)];
+      while (*link != node) link = &(*link)->next;
+      *link = node->next;
+      --stripe.size;
+    }
+    Destroy(node);
+  }
+
+  // Number of distinct instances currently interned.
+  [[nodiscard]] size_t size() {
+    size_t total = 0;
+    for (Stripe& stripe : stripes_) {
+      std::lock_guard<std::mutex> lock(stripe.mutex);
+      total += stripe.size;
+    }
+    return total;
+  }
+
+  [[nodiscard]] static size_t use_count(const T* p) noexcept {
+    return NodeOf(p)->refs.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static Node* NodeOf(const T* p) noexcept {
+    return reinterpret_cast<Node*>(
+        const_cast<char*>(reinterpret_cast<const char*>(p) - offsetof(Node, data)));
+  }
+
+  // Stripes are picked by the high bits and buckets by the low bits of the
+  // mixed hash, so the two choices stay independent.
+  static size_t Mix(size_t hash) noexcept {
+    return static_cast<size_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull) ^
+                               (static_cast<uint64_t>(hash) >> 29));
+  }
+
+  Stripe& StripeOf(size_t hash) noexcept { return stripes_[(hash >> 58) % kStripes]; }
+
+  static size_t BucketOf(const Stripe& stripe, size_t hash) noexcept {
+    return hash & (stripe.buckets.size() - 1);
+  }
+
+  template <typename U>
+  const T* Intern(U&& value) {
+    size_t hash = Mix(Hash{}(value));
+    Stripe& stripe = StripeOf(hash);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    if (stripe.buckets.empty()) stripe.buckets.assign(kMinBuckets, nullptr);
+    for (Node* node = stripe.buckets[BucketOf(stripe, hash)]; node; node = node->next) {
+      if (node->hash == hash && KeyEqual{}(node->value(), value)) {
+        node->refs.fetch_add(1, std::memory_order_relaxed);
+        return &node->value();
+      }
+    }
+    if (stripe.size + 1 > stripe.buckets.size() * kMaxLoad) Grow(stripe);
+    Node* node = new (nodes_.allocate()) Node;
+    try {
+      new (node->data) T(std::forward<U>(value));
+    } catch (...) {
+      nodes_.destroy(node);
+      throw;
+    }
+    node->hash = hash;
+    node->refs.store(1, std::memory_order_relaxed);
+    Node*& head = stripe.buckets[BucketOf(stripe, hash)];
+    node->next = head;
+    head = node;
+    ++stripe.size;
+    return &node->value();
+  }
+
+  static void Grow(Stripe& stripe) {
+    std::vector<Node*> buckets(stripe.buckets.size() * 2, nullptr);
+    for (Node* node : stripe.buckets) {
+      while (node) {
+        Node* next = node->next;
+        Node*& head = buckets[node->hash & (buckets.size() - 1)];
+        node->next = head;
+        head = node;
+        node = next;
+      }
+    }
+    stripe.buckets.swap(buckets);
+  }
+
+  // The Node itself is trivially destructible; only the value needs it.
+  void Destroy(Node* node) noexcept {
+    std::launder(reinterpret_cast<T*>(node->data))->~T();
+    nodes_.destroy(node);
+  }
+};
@@ -0,0 +1,266 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <new>
+
+// Pool that segregates objects by predicted lifetime. Every kSampleInterval-th
+// allocation is sampled: its allocation site (the caller's return address, or
+// an explicit tag) and birth time are remembered until it is freed, and each
+// site accumulates how many of its samples died within `short_lifetime`
+// allocations. Sites whose samples mostly die young are served from nursery
+// slabs, everything else from tenured slabs, so short-lived objects no longer
+// pin slabs next to survivors and nursery slabs empty out together for trim().
+// Like PoolAllocator, it is not thread-safe.
+template <typename T, size_t kSlabBytes = 16384>
+class LifetimePool {
+  static_assert((kSlabBytes & (kSlabBytes - 1)) == 0, "Slab size must be a power of two");
+
+ public:
+  using SiteTag = uintptr_t;
+
+  static constexpr size_t kSampleInterval = 64;
+  static constexpr size_t kMinSamples = 8;
+
+  explicit LifetimePool(bool segregate = true, uint64_t short_lifetime = 4096) noexcept
+      : segregate_(segregate), short_lifetime_(short_lifetime) {}
+
+  LifetimePool(const LifetimePool&) = delete;
+  LifetimePool& operator=(const LifetimePool&) = delete;
+
+  // Frees every slab. Objects still allocated become dangling.
+  ~LifetimePool() noexcept {
+    for (Arena& arena : arenas_) {
+      for (Slab* list : {arena.partial, arena.full}) {
+        while (list) {
+          Slab* next = list->next;
+          ::operator delete(list, std::align_val_t{kSlabBytes});
+          list = next;
+        }
+      }
+    }
+  }
+
+  // Allocates on behalf of the caller's call site.
+  [[nodiscard]] __attribute__((noinline)) T* allocate() {
+    return allocate(reinterpret_cast<SiteTag>(__builtin_return_address(0)));
+  }
+
+  // Allocates on behalf of an explicit, nonzero site tag.
+  [[nodiscard]] T* allocate(SiteTag site) {
+    ++clock_;
+    Site* stats = FindSite(site);
+    bool nursery = segregate_ && stats && stats->PredictsShort();
+    Chunk* chunk = Take(arenas_[nursery ? kNursery : kTenured]);
+    if (stats && clock_ % kSampleInterval == 0) {
+      Sample(chunk, stats);
+    }
+    return std::launder(reinterpret_cast<T*>(chunk->data));
+  }
+
+  void deallocate(T* p) noexcept {
+    if (!p) return;
+    Chunk* chunk = std::launder(reinterpret_cast<Chunk*>(p));
+    Resolve(chunk);
+    Give(chunk);
+  }
+
+  // Releases every slab that holds no live object. Returns how many.
+  size_t trim() noexcept {
+    size_t released = 0;
+    for (Arena& arena : arenas_) {
+      for (Slab* slab = arena.partial; slab;) {
+        Slab* next = slab->next;
+        if (slab->live == 0) {
+          Unlink(arena.partial, slab);
+          --arena.slab_count;
+          ::operator delete(slab, std::align_val_t{kSlabBytes});
+          ++released;
+        }
+        slab = next;
+      }
+    }
+    return released;
+  }
+
+  [[nodiscard]] size_t slab_count() const noexcept {
+    return arenas_[kNursery].slab_count + arenas_[kTenured].slab_count;
+  }
+  [[nodiscard]] size_t nursery_slab_count() const noexcept {
+    return arenas_[kNursery].slab_count;
+  }
+  [[nodiscard]] size_t reserved_bytes() const noexcept { return slab_count() * kSlabBytes; }
+  [[nodiscard]] size_t live() const noexcept { return live_; }
+
+ private:
+  union Chunk {
+    Chunk* next;
+    alignas(T) char data[sizeof(T)];
+  };
+
+  struct Slab {
+    Slab* next;
+    Slab* prev;
+    Chunk* free_list;
+    size_t live;
+    size_t bumped;
+    size_t arena;
+  };
+
+  struct Arena {
+    Slab* partial = nullptr;
+    Slab* full = nullptr;
+    size_t slab_count = 0;
+  };
+
+  struct Site {
+    SiteTag tag = 0;
+    uint32_t samples = 0;
+    uint32_t short_samples = 0;
+
+    bool PredictsShort() const noexcept {
+      return samples >= kMinSamples && short_samples * 2 > samples;
+    }
+  };
+
+  struct LiveSample {
+    Chunk* chunk = nullptr;
+    Site* site = nullptr;
+    uint64_t birth = 0;
+  };
+
+  static constexpr size_t kNursery = 0;
+  static constexpr size_t kTenured = 1;
+  static constexpr size_t kSites = 256;
+  static constexpr size_t kLiveSamples = 256;
+  static constexpr size_t kHeader =
+      ((sizeof(Slab) + alignof(Chunk) - 1) / alignof(Chunk)) * alignof(Chunk);
+  static constexpr size_t kChunksPerSlab = (kSlabBytes - kHeader) / sizeof(Chunk);
+  static_assert(kChunksPerSlab > 0, "Slab too small for one object");
+
+  static Slab* SlabOf(Chunk* chunk) noexcept {
+    return reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(chunk) & ~(kSlabBytes - 1));
+  }
+
+  static Chunk* ChunkAt(Slab* slab, size_t index) noexcept {
+    return reinterpret_cast<Chunk*>(reinterpret_cast<char*>(slab) + kHeader) + index;
+  }
+
+  static bool HasRoom(const Slab* slab) noexcept { return slab->live < kChunksPerSlab; }
+
+  static void PushFront(Slab*& list, Slab* slab) noexcept {
+    slab->prev = nullptr;
+    slab->next = list;
+    if (list) list->prev = slab;
+    list = slab;
+  }
+
+  static void Unlink(Slab*& list, Slab* slab) noexcept {
+    if (slab->prev) {
+      slab->prev->next = slab->next;
+    } else {
+      list = slab->next;
+    }
+    if (slab->next) slab->next->prev = slab->prev;
+  }
+
+  Chunk* Take(Arena& arena) {
+    Slab* slab = arena.partial;
+    if (!slab) {
+      slab = NewSlab(static_cast<size_t>(&arena - arenas_));
+    }
+    Chunk* chunk = slab->free_list;
+    if (chunk) {
+      slab->free_list = chunk->next;
+    } else {
+      chunk = ChunkAt(slab, slab->bumped++);
+    }
+    ++slab->live;
+    ++live_;
+    if (!HasRoom(slab)) {
+      Unlink(arena.partial, slab);
+      PushFront(arena.full, slab);
+    }
+    return chunk;
+  }
+
+  void Give(Chunk* chunk) noexcept {
+    Slab* slab = SlabOf(chunk);
+    Arena& arena = arenas_[slab->arena];
+    if (!HasRoom(slab)) {
+      Unlink(arena.full, slab);
+      PushFront(arena.partial, slab);
+    }
+    chunk->next = slab->free_list;
+    slab->free_list = chunk;
+    --slab->live;
+    --live_;
+  }
+
+  Slab* NewSlab(size_t arena_index) {
+    void* memory;
+    try {
+      memory = ::operator new(kSlabBytes, std::align_val_t{kSlabBytes});
+    } catch (const std::bad_alloc& e) {
+      std::cerr << "LifetimePool::allocate: Memory allocation failed: " << e.what() << "\n";
+      throw;
+    }
+    Slab* slab = static_cast<Slab*>(memory);
+    slab->free_list = nullptr;
+    slab->live = 0;
+    slab->bumped = 0;
+    slab->arena = arena_index;
+    Arena& arena = arenas_[arena_index];
+    PushFront(arena.partial, slab);
+    ++arena.slab_count;
+    return slab;
+  }
+
+  // Returns the statistics slot for `tag`, claiming one if needed, or
+  // nullptr once the table is full.
+  Site* FindSite(SiteTag tag) noexcept {
+    size_t index = Mix(tag) % kSites;
+    for (size_t probe = 0; probe < kSites; ++probe) {
+      Site& site = sites_[(index + probe) % kSites];
+      if (site.tag == tag) return &site;
+      if (site.tag == 0) {
+        site.tag = tag;
+        return &site;
+      }
+    }
+    return nullptr;
+  }
+
+  static size_t Mix(uintptr_t value) noexcept {
+    return static_cast<size_t>((value * 0x9E3779B97F4A7C15ull) >> 32);
+  }
+
+  static size_t SampleIndex(Chunk* chunk) noexcept {
+    return Mix(reinterpret_cast<uintptr_t>(chunk)) % kLiveSamples;
+  }
+
+  // Records a sampled birth in the chunk's direct-mapped slot. A sample it
+  // displaces counts as long-lived if it is already past the threshold and
+  // is dropped otherwise.
+  void Sample(Chunk* chunk, Site* site) noexcept {
+    LiveSample& slot = samples_[SampleIndex(chunk)];
+    if (slot.chunk && clock_ - slot.birth >= short_lifetime_) ++slot.site->samples;
+    slot = LiveSample{chunk, site, clock_};
+  }
+
+  void Resolve(Chunk* chunk) noexcept {
+    LiveSample& slot = samples_[SampleIndex(chunk)];
+    if (slot.chunk != chunk) return;
+    ++slot.site->samples;
+    if (clock_ - slot.birth < short_lifetime_) ++slot.site->short_samples;
+    slot = LiveSample{};
+  }
+
+  bool segregate_;
+  uint64_t short_lifetime_;
+  uint64_t clock_ = 0;
+  size_t live_ = 0;
+  Arena arenas_[2];
+  Site sites_[kSites];
+  LiveSample samples_[kLiveSamples];
+};
@@ -0,0 +1,226 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Log-structured pool for objects allocated in time order and freed mostly in
+// time order. Objects are appended to the head segment and each segment tracks
+// its live count. Segments that empty out are recycled on the spot; whenever
+// an allocation starts a new head, sealed segments with fewer than
+// `clean_threshold` live slots have their survivors moved to the head and are
+// recycled too. Objects are therefore addressed through handles, and get()
+// pointers stay valid only until the next allocate() returns. Like
+// PoolAllocator, it is not thread-safe.
+template <typename T, size_t kSegmentObjects = 1024>
+class LogStructuredPool {
+  static_assert(kSegmentObjects > 0, "Segment size must be positive");
+
+ public:
+  using Handle = uint32_t;
+  static constexpr Handle kNullHandle = ~Handle{0};
+
+  explicit LogStructuredPool(double clean_threshold = 0.25)
+      : clean_below_(static_cast<size_t>(clean_threshold * kSegmentObjects)) {
+    spare_.reserve(1);
+  }
+
+  LogStructuredPool(const LogStructuredPool&) = delete;
+  LogStructuredPool& operator=(const LogStructuredPool&) = delete;
+
+  ~LogStructuredPool() noexcept {
+    for (const Entry& entry : handles_) {
+      if (entry.segment) entry.segment->slots[entry.index].object()->~T();
+    }
+    for (Segment* segment : segments_) FreeSegment(segment);
+    for (Segment* segment : spare_) FreeSegment(segment);
+  }
+
+  // Constructs a T at the head of the log and returns its handle. The
+  // arguments may refer to pooled objects (`allocate(*get(h))`): the object is
+  // constructed before cleaning can move anything.
+  template <typename... Args>
+  Handle allocate(Args&&... args) {
+    Handle handle = NewHandle();
+    bool sealed = head_ && head_->appended == kSegmentObjects;
+    try {
+      Place(handle, std::forward<Args>(args)...);
+    } catch (...) {
+      ReleaseHandle(handle);
+      throw;
+    }
+    ++live_;
+    if (sealed) {
+      // Cleaning only reclaims space; if it fails, the remaining sparse
+      // segments wait for the next time the head fills up.
+      try {
+        CleanSparseSegments();
+      } catch (...) {
+      }
+    }
+    return handle;
+  }
+
+  [[nodiscard]] T* get(Handle handle) noexcept {
+    const Entry& entry = handles_[handle];
+    return entry.segment->slots[entry.index].object();
+  }
+
+  [[nodiscard]] const T* get(Handle handle) const noexcept {
+    const Entry& entry = handles_[handle];
+    return entry.segment->slots[entry.index].object();
+  }
+
+  void free(Handle handle) noexcept {
+    Entry& entry = handles_[handle];
+    Segment* segment = entry.segment;
+    segment->slots[entry.index].object()->~T();
+    segment->slots[entry.index].handle = kNullHandle;
+    ReleaseHandle(handle);
+    --live_;
+    if (--segment->live == 0 && segment != head_) Recycle(segment);
+  }
+
+  [[nodiscard]] size_t live() const noexcept { return live_; }
+  [[nodiscard]] size_t segment_count() const noexcept { return segments_.size(); }
+  [[nodiscard]] size_t reserved_bytes() const noexcept {
+    return (segments_.size() + spare_.size()) * sizeof(Segment);
+  }
+
+  // Fraction of segment slots holding live objects.
+  [[nodiscard]] double utilization() const noexcept {
+    return segments_.empty() ? 1.0
+                             : static_cast<double>(live_) /
+                                   static_cast<double>(segments_.size() * kSegmentObjects);
+  }
+
+ private:
+  struct Slot {
+    Handle handle;
+    alignas(T) char data[sizeof(T)];
+
+    T* object() noexcept { return std::launder(reinterpret_cast<T*>(data)); }
+  };
+
+  struct Segment {
+    size_t position;  // index in segments_
+    size_t live;
+    size_t appended;
+    Slot slots[kSegmentObjects];
+  };
+
+  // A free entry has no segment and chains to the next free handle through
+  // `index`.
+  struct Entry {
+    Segment* segment;
+    size_t index;
+  };
+
+  Handle NewHandle() {
+    if (free_handle_ != kNullHandle) {
+      Handle handle = free_handle_;
+      free_handle_ = static_cast<Handle>(handles_[handle].index);
+      return handle;
+    }
+    handles_.push_back(Entry{nullptr, kNullHandle});
+    return static_cast<Handle>(handles_.size() - 1);
+  }
+
+  void ReleaseHandle(Handle handle) noexcept {
+    handles_[handle] = Entry{nullptr, free_handle_};
+    free_handle_ = handle;
+  }
+
+  // Constructs the object for `handle` in the next slot of the head segment,
+  // starting a new head when it is full.
+  template <typename... Args>
+  void Place(Handle handle, Args&&... args) {
+    if (!head_ || head_->appended == kSegmentObjects) head_ = NewSegment();
+    Slot& slot = head_->slots[head_->appended];
+    new (slot.data) T(std::forward<Args>(args)...);
+    slot.handle = handle;
+    handles_[handle] = Entry{head_, head_->appended};
+    ++head_->appended;
+    ++head_->live;
+  }
+
+  Segment* NewSegment() {
+    segments_.reserve(segments_.size() + 1);
+    Segment* segment;
+    if (!spare_.empty()) {
+      segment = spare_.back();
+      spare_.pop_back();
+    } else {
+      try {
+        segment = static_cast<Segment*>(
+            ::operator new(sizeof(Segment), std::align_val_t{alignof(Segment)}));
+      } catch (const std::bad_alloc& e) {
+        std::cerr << "LogStructuredPool::allocate: Memory allocation failed: " << e.what()
+                  << "\n";
+        throw;
+      }
+    }
+    segment->live = 0;
+    segment->appended = 0;
+    segment->position = segments_.size();
+    segments_.push_back(segment);
+    return segment;
+  }
+
+  // Cleans every sealed segment below the threshold. Cleaning recycles the
+  // segment at `i`, which moves another one into that position.
+  void CleanSparseSegments() {
+    for (size_t i = 0; i < segments_.size();) {
+      Segment* segment = segments_[i];
+      if (segment != head_ && segment->live < clean_below_) {
+        Clean(segment);
+      } else {
+        ++i;
+      }
+    }
+  }
+
+  // Moves every survivor of `segment` to the head of the log, updating its
+  // handle, then recycles the segment.
+  void Clean(Segment* segment) {
+    for (size_t i = 0; i < segment->appended && segment->live; ++i) {
+      Slot& slot = segment->slots[i];
+      if (slot.handle == kNullHandle) continue;
+      T* object = slot.object();
+      Place(slot.handle, std::move(*object));
+      slot.handle = kNullHandle;
+      object->~T();
+      --segment->live;
+    }
+    Recycle(segment);
+  }
+
+  // Unlinks an empty segment from the log and keeps one spare for reuse.
+  void Recycle(Segment* segment) noexcept {
+    Segment* last = segments_.back();
+    last->position = segment->position;
+    segments_[segment->position] = last;
+    segments_.pop_back();
+    if (spare_.empty()) {
+      spare_.push_back(segment);
+    } else {
+      FreeSegment(segment);
+    }
+  }
+
+  // Segments are allocated with their own alignment, which exceeds the
+  // default for over-aligned T.
+  static void FreeSegment(Segment* segment) noexcept {
+    ::operator delete(segment, std::align_val_t{alignof(Segment)});
+  }
+
+  size_t clean_below_;
+  size_t live_ = 0;
+  Segment* head_ = nullptr;
+  std::vector<Segment*> segments_;
+  std::vector<Segment*> spare_;
+  std::vector<Entry> handles_;
+  Handle free_handle_ = kNullHandle;
+};
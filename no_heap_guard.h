@@ -0,0 +1,159 @@
+#pragma once
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// Debug utility that catches heap allocations on hot paths. While a
+// NoHeapGuard is alive, every global operator new and (on glibc) malloc,
+// calloc and realloc made by the same thread is counted, or aborts the
+// process in Mode::kAbort. Allocations served by pools in this project never
+// reach those functions, so a pool-backed hot path should count zero once
+// the pools are warmed up; a pool that has to grow a slab inside the guard is
+// reported like any other heap call.
+//
+// The interception hooks are replacement allocation functions, so exactly one
+// translation unit of the program must define them:
+//
+//   #define NO_HEAP_GUARD_IMPLEMENTATION
+//   #include "no_heap_guard.h"
+class NoHeapGuard {
+ public:
+  enum class Mode { kCount, kAbort };
+
+  explicit NoHeapGuard(Mode mode = Mode::kCount) noexcept
+      : start_(State().allocations), saved_abort_(State().abort) {
+    ++State().depth;
+    if (mode == Mode::kAbort) State().abort = true;
+  }
+
+  NoHeapGuard(const NoHeapGuard&) = delete;
+  NoHeapGuard& operator=(const NoHeapGuard&) = delete;
+
+  ~NoHeapGuard() noexcept {
+    --State().depth;
+    State().abort = saved_abort_;
+  }
+
+  // Heap allocations this thread has made since the guard was created.
+  [[nodiscard]] size_t allocations() const noexcept { return State().allocations - start_; }
+
+  // Whether the interception hooks are linked in; without them every guard
+  // counts zero.
+  [[nodiscard]] static bool hooks_installed() noexcept { return HooksInstalled(); }
+
+  // Called by the hooks for every allocation.
+  static void OnAllocation(size_t bytes) noexcept {
+    ThreadState& state = State();
+    if (state.depth == 0) return;
+    ++state.allocations;
+    if (state.abort) {
+      std::fprintf(stderr, "NoHeapGuard: heap allocation of %zu bytes inside a guard\n", bytes);
+      std::abort();
+    }
+  }
+
+  static bool& HooksInstalled() noexcept {
+    static bool installed = false;
+    return installed;
+  }
+
+ private:
+  struct ThreadState {
+    size_t depth = 0;
+    size_t allocations = 0;
+    bool abort = false;
+  };
+
+  static ThreadState& State() noexcept {
+    thread_local ThreadState state;
+    return state;
+  }
+
+  size_t start_;
+  bool saved_abort_;
+};
+
+#ifdef NO_HEAP_GUARD_IMPLEMENTATION
+
+#ifdef __GLIBC__
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* p, size_t size);
+
+void* malloc(size_t size) {
+  NoHeapGuard::OnAllocation(size);
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+  NoHeapGuard::OnAllocation(count * size);
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* p, size_t size) {
+  NoHeapGuard::OnAllocation(size);
+  return __libc_realloc(p, size);
+}
+}
+#define NO_HEAP_GUARD_RAW_MALLOC __libc_malloc
+#else
+#define NO_HEAP_GUARD_RAW_MALLOC std::malloc
+#endif
+
+namespace no_heap_guard_detail {
+
+inline void* Allocate(size_t size) noexcept {
+  NoHeapGuard::OnAllocation(size);
+  return NO_HEAP_GUARD_RAW_MALLOC(size ? size : 1);
+}
+
+inline void* AllocateAligned(size_t size, std::align_val_t alignment) noexcept {
+  NoHeapGuard::OnAllocation(size);
+  size_t align = static_cast<size_t>(alignment);
+  return std::aligned_alloc(align, (size + align - 1) / align * align);
+}
+
+struct Installer {
+  Installer() noexcept { NoHeapGuard::HooksInstalled() = true; }
+};
+static Installer installer;
+
+}  // namespace no_heap_guard_detail
+
+void* operator new(size_t size) {
+  if (void* p = no_heap_guard_detail::Allocate(size)) return p;
+  throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return ::operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return no_heap_guard_detail::Allocate(size);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return no_heap_guard_detail::Allocate(size);
+}
+void* operator new(size_t size, std::align_val_t alignment) {
+  if (void* p = no_heap_guard_detail::AllocateAligned(size, alignment)) return p;
+  throw std::bad_alloc();
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+  return ::operator new(size, alignment);
+}
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  return no_heap_guard_detail::AllocateAligned(size, alignment);
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  return no_heap_guard_detail::AllocateAligned(size, alignment);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+#endif  // NO_HEAP_GUARD_IMPLEMENTATION
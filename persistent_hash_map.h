@@ -0,0 +1,392 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "pool_allocator.h"
+
+// Persistent hash array mapped trie. Every update returns a new version that
+// shares all untouched nodes with the old one, so set() and erase() allocate
+// O(log n) nodes instead of copying the map. Nodes with k children come from
+// the k-th run cache of a pool shared by all versions, and are kept alive by
+// intrusive reference counts. Like PoolAllocator, it is not thread-safe.
+template <typename K, typename V, typename Hash = std::hash<K>,
+          typename KeyEqual = std::equal_to<K>, size_t kBlockSize = 1024>
+class PersistentHashMap {
+ private:
+  static constexpr unsigned kBits = 5;
+  static constexpr unsigned kFanout = 1u << kBits;
+  static constexpr unsigned kMask = kFanout - 1;
+
+  // A slot holds either a Node* or a Leaf* tagged with kLeafTag.
+  using Slot = uintptr_t;
+  static constexpr Slot kLeafTag = 1;
+
+  struct Node {
+    uint32_t refcount;
+    uint32_t bitmap;
+
+    Slot* slots() noexcept { return reinterpret_cast<Slot*>(this + 1); }
+    unsigned count() const noexcept { return static_cast<unsigned>(__builtin_popcount(bitmap)); }
+  };
+
+  // Leaves with equal hashes form an immutable chain through `next`.
+  struct Leaf {
+    uint32_t refcount;
+    size_t hash;
+    Leaf* next;
+    K key;
+    V value;
+  };
+
+  struct NodePool {
+    PoolRunCache nodes[kFanout + 1];
+    PoolRunCache leaves;
+
+    NodePool() noexcept {
+      for (unsigned k = 1; k <= kFanout; ++k) {
+        nodes[k].Reset(sizeof(Node) + k * sizeof(Slot), alignof(Node), kBlockSize);
+      }
+      leaves.Reset(sizeof(Leaf), alignof(Leaf), kBlockSize);
+    }
+  };
+
+  std::shared_ptr<NodePool> pool_;
+  Node* root_ = nullptr;
+  size_t size_ = 0;
+
+  PersistentHashMap(std::shared_ptr<NodePool> pool, Node* root, size_t size) noexcept
+      : pool_(std::move(pool)), root_(root), size_(size) {}
+
+ public:
+  using key_type = K;
+  using mapped_type = V;
+  using size_type = size_t;
+
+  PersistentHashMap() : pool_(std::make_shared<NodePool>()) {}
+
+  PersistentHashMap(const PersistentHashMap& other) noexcept
+      : pool_(other.pool_), root_(other.root_), size_(other.size_) {
+    if (root_) ++root_->refcount;
+  }
+
+  PersistentHashMap(PersistentHashMap&& other) noexcept
+      : pool_(other.pool_), root_(other.root_), size_(other.size_) {
+    other.root_ = nullptr;
+    other.size_ = 0;
+  }
+
+  PersistentHashMap& operator=(const PersistentHashMap& other) noexcept {
+    if (this != &other) {
+      PersistentHashMap temp(other);
+      swap(temp);
+    }
+    return *this;
+  }
+
+  PersistentHashMap& operator=(PersistentHashMap&& other) noexcept {
+    if (this != &other) {
+      PersistentHashMap temp(std::move(other));
+      swap(temp);
+    }
+    return *this;
+  }
+
+  ~PersistentHashMap() noexcept {
+    if (root_) Unref(reinterpret_cast<Slot>(root_));
+  }
+
+  [[nodiscard]] size_t size() const noexcept { return size_; }
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+  // Returns the value stored under `key`, or nullptr.
+  [[nodiscard]] const V* find(const K& key) const {
+    size_t hash = Hash{}(key);
+    Node* node = root_;
+    for (unsigned shift = 0; node; shift += kBits) {
+      uint32_t bit = 1u << ((hash >> shift) & kMask);
+      if (!(node->bitmap & bit)) return nullptr;
+      Slot slot = node->slots()[Index(node->bitmap, bit)];
+      if (!IsLeaf(slot)) {
+        node = AsNode(slot);
+        continue;
+      }
+      for (Leaf* leaf = AsLeaf(slot); leaf; leaf = leaf->next) {
+        if (leaf->hash == hash && KeyEqual{}(leaf->key, key)) return &leaf->value;
+      }
+      return nullptr;
+    }
+    return nullptr;
+  }
+
+  [[nodiscard]] bool contains(const K& key) const { return find(key) != nullptr; }
+
+  // Returns a version in which `key` maps to `value`.
+  [[nodiscard]] PersistentHashMap set(const K& key, const V& value) const {
+    bool added = false;
+    Node* root = Assoc(root_, 0, Hash{}(key), key, value, added);
+    return PersistentHashMap(pool_, root, size_ + (added ? 1 : 0));
+  }
+
+  // Returns a version without `key`.
+  [[nodiscard]] PersistentHashMap erase(const K& key) const {
+    if (!root_) return *this;
+    bool removed = false;
+    Slot root = Dissoc(root_, 0, Hash{}(key), key, removed);
+    if (!removed) return *this;
+    return PersistentHashMap(pool_, AsNode(root), size_ - 1);
+  }
+
+  // Calls `fn(key, value)` for every entry in unspecified order.
+  template <typename Fn>
+  void for_each(Fn&& fn) const {
+    if (root_) Visit(reinterpret_cast<Slot>(root_), fn);
+  }
+
+  void swap(PersistentHashMap& other) noexcept {
+    std::swap(pool_, other.pool_);
+    std::swap(root_, other.root_);
+    std::swap(size_, other.size_);
+  }
+
+ private:
+  static bool IsLeaf(Slot slot) noexcept { return slot & kLeafTag; }
+  static Node* AsNode(Slot slot) noexcept { return reinterpret_cast<Node*>(slot); }
+  static Leaf* AsLeaf(Slot slot) noexcept { return reinterpret_cast<Leaf*>(slot & ~kLeafTag); }
+  static Slot FromLeaf(Leaf* leaf) noexcept { return reinterpret_cast<Slot>(leaf) | kLeafTag; }
+
+  static unsigned Index(uint32_t bitmap, uint32_t bit) noexcept {
+    return static_cast<unsigned>(__builtin_popcount(bitmap & (bit - 1)));
+  }
+
+  static void Ref(Slot slot) noexcept {
+    if (IsLeaf(slot)) {
+      ++AsLeaf(slot)->refcount;
+    } else {
+      ++AsNode(slot)->refcount;
+    }
+  }
+
+  void Unref(Slot slot) const noexcept {
+    if (IsLeaf(slot)) {
+      Leaf* leaf = AsLeaf(slot);
+      while (leaf && --leaf->refcount == 0) {
+        Leaf* next = leaf->next;
+        leaf->~Leaf();
+        pool_->leaves.deallocate(leaf);
+        leaf = next;
+      }
+      return;
+    }
+    Node* node = AsNode(slot);
+    if (--node->refcount != 0) return;
+    unsigned count = node->count();
+    for (unsigned i = 0; i < count; ++i) {
+      Unref(node->slots()[i]);
+    }
+    pool_->nodes[count].deallocate(node);
+  }
+
+  Node* NewNode(uint32_t bitmap) const {
+    Node* node = static_cast<Node*>(pool_->nodes[__builtin_popcount(bitmap)].allocate());
+    node->refcount = 1;
+    node->bitmap = bitmap;
+    return node;
+  }
+
+  Leaf* NewLeaf(size_t hash, const K& key, const V& value, Leaf* next) const {
+    void* memory = pool_->leaves.allocate();
+    try {
+      return new (memory) Leaf{1, hash, next, key, value};
+    } catch (...) {
+      pool_->leaves.deallocate(memory);
+      throw;
+    }
+  }
+
+  // Copies `node` with the slot at `index` replaced by `slot`, taking a new
+  // reference on every other child. Owns `slot`, which is released if the
+  // copy cannot be allocated.
+  Node* CopyWith(Node* node, unsigned index, Slot slot) const {
+    Node* copy;
+    try {
+      copy = NewNode(node->bitmap);
+    } catch (...) {
+      Unref(slot);
+      throw;
+    }
+    unsigned count = node->count();
+    for (unsigned i = 0; i < count; ++i) {
+      copy->slots()[i] = i == index ? slot : node->slots()[i];
+      if (i != index) Ref(copy->slots()[i]);
+    }
+    return copy;
+  }
+
+  // Builds the subtree that holds two slots whose hashes agree below `shift`.
+  // Owns `a` and `b`, which are released if the subtree cannot be allocated.
+  Node* MakePair(unsigned shift, Slot a, size_t hash_a, Slot b, size_t hash_b) const {
+    unsigned index_a = (hash_a >> shift) & kMask;
+    unsigned index_b = (hash_b >> shift) & kMask;
+    if (index_a == index_b) {
+      Node* child = MakePair(shift + kBits, a, hash_a, b, hash_b);
+      return NewSingleton(1u << index_a, reinterpret_cast<Slot>(child));
+    }
+    Node* node;
+    try {
+      node = NewNode((1u << index_a) | (1u << index_b));
+    } catch (...) {
+      Unref(a);
+      Unref(b);
+      throw;
+    }
+    node->slots()[index_a < index_b ? 0 : 1] = a;
+    node->slots()[index_a < index_b ? 1 : 0] = b;
+    return node;
+  }
+
+  // Returns a copy of the chain starting at `head` in which `key` maps to
+  // `value`. Leaves after the updated one are shared; they gain their
+  // reference only once the leaf that points at them exists.
+  Leaf* ChainAssoc(Leaf* head, size_t hash, const K& key, const V& value, bool& added) const {
+    Leaf* match = head;
+    while (match && !KeyEqual{}(match->key, key)) match = match->next;
+    if (!match) {
+      Leaf* leaf = NewLeaf(hash, key, value, head);
+      ++head->refcount;
+      added = true;
+      return leaf;
+    }
+    Leaf* result = NewLeaf(hash, key, value, match->next);
+    if (match->next) ++match->next->refcount;
+    return CopyPrefix(head, match, result);
+  }
+
+  // Copies the leaves from `head` up to (excluding) `stop` in front of `tail`.
+  // Owns `tail`, which is released along with any copies made so far if an
+  // allocation throws.
+  Leaf* CopyPrefix(Leaf* head, Leaf* stop, Leaf* tail) const {
+    if (head == stop) return tail;
+    Leaf* rest = CopyPrefix(head->next, stop, tail);
+    try {
+      return NewLeaf(head->hash, head->key, head->value, rest);
+    } catch (...) {
+      Unref(FromLeaf(rest));
+      throw;
+    }
+  }
+
+  // Allocates a node whose only child is `slot`, releasing `slot` on failure.
+  Node* NewSingleton(uint32_t bit, Slot slot) const {
+    Node* node;
+    try {
+      node = NewNode(bit);
+    } catch (...) {
+      Unref(slot);
+      throw;
+    }
+    node->slots()[0] = slot;
+    return node;
+  }
+
+  Node* Assoc(Node* node, unsigned shift, size_t hash, const K& key, const V& value,
+              bool& added) const {
+    uint32_t bit = 1u << ((hash >> shift) & kMask);
+    if (!node) {
+      Node* fresh = NewSingleton(bit, FromLeaf(NewLeaf(hash, key, value, nullptr)));
+      added = true;
+      return fresh;
+    }
+    unsigned index = Index(node->bitmap, bit);
+    if (!(node->bitmap & bit)) {
+      Slot leaf = FromLeaf(NewLeaf(hash, key, value, nullptr));
+      Node* copy;
+      try {
+        copy = NewNode(node->bitmap | bit);
+      } catch (...) {
+        Unref(leaf);
+        throw;
+      }
+      added = true;
+      unsigned count = node->count();
+      for (unsigned i = 0, j = 0; i <= count; ++i) {
+        if (i == index) {
+          copy->slots()[i] = leaf;
+        } else {
+          copy->slots()[i] = node->slots()[j++];
+          Ref(copy->slots()[i]);
+        }
+      }
+      return copy;
+    }
+    Slot slot = node->slots()[index];
+    Slot replacement;
+    if (!IsLeaf(slot)) {
+      replacement = reinterpret_cast<Slot>(Assoc(AsNode(slot), shift + kBits, hash, key, value, added));
+    } else if (AsLeaf(slot)->hash == hash) {
+      replacement = FromLeaf(ChainAssoc(AsLeaf(slot), hash, key, value, added));
+    } else {
+      Leaf* existing = AsLeaf(slot);
+      Slot leaf = FromLeaf(NewLeaf(hash, key, value, nullptr));
+      ++existing->refcount;
+      replacement = reinterpret_cast<Slot>(
+          MakePair(shift + kBits, slot, existing->hash, leaf, hash));
+      added = true;
+    }
+    return CopyWith(node, index, replacement);
+  }
+
+  // Returns the slot that replaces `node` once `key` is removed: 0 when the
+  // node empties, and a lone leaf below the root is pulled up a level.
+  Slot Dissoc(Node* node, unsigned shift, size_t hash, const K& key, bool& removed) const {
+    uint32_t bit = 1u << ((hash >> shift) & kMask);
+    if (!(node->bitmap & bit)) return 0;
+    unsigned index = Index(node->bitmap, bit);
+    Slot slot = node->slots()[index];
+    Slot replacement;
+    if (!IsLeaf(slot)) {
+      replacement = Dissoc(AsNode(slot), shift + kBits, hash, key, removed);
+    } else {
+      Leaf* head = AsLeaf(slot);
+      Leaf* match = head;
+      while (match && !(match->hash == hash && KeyEqual{}(match->key, key))) match = match->next;
+      if (!match) return 0;
+      removed = true;
+      if (match->next) ++match->next->refcount;
+      Leaf* chain = CopyPrefix(head, match, match->next);
+      replacement = chain ? FromLeaf(chain) : 0;
+    }
+    if (!removed) return 0;
+    if (replacement) {
+      if (shift > 0 && node->count() == 1 && IsLeaf(replacement)) return replacement;
+      return reinterpret_cast<Slot>(CopyWith(node, index, replacement));
+    }
+    unsigned count = node->count();
+    if (count == 1) return 0;
+    if (shift > 0 && count == 2 && IsLeaf(node->slots()[1 - index])) {
+      Slot survivor = node->slots()[1 - index];
+      Ref(survivor);
+      return survivor;
+    }
+    Node* copy = NewNode(node->bitmap & ~bit);
+    for (unsigned i = 0, j = 0; i < count; ++i) {
+      if (i == index) continue;
+      copy->slots()[j] = node->slots()[i];
+      Ref(copy->slots()[j++]);
+    }
+    return reinterpret_cast<Slot>(copy);
+  }
+
+  template <typename Fn>
+  static void Visit(Slot slot, Fn& fn) {
+    if (IsLeaf(slot)) {
+      for (Leaf* leaf = AsLeaf(slot); leaf; leaf = leaf->next) fn(leaf->key, leaf->value);
+      return;
+    }
+    Node* node = AsNode(slot);
+    unsigned count = node->count();
+    for (unsigned i = 0; i < count; ++i) Visit(node->slots()[i], fn);
+  }
+};
@@ -2,9 +2,182 @@
 #include <iostream>
 #include <memory>
 #include <cstdlib>
+#include <limits>
 #include <new>
 #include <type_traits>
 
+// Free list of fixed-size runs carved from slabs whose capacity doubles each
+// time the list runs dry, up to a cap. A one-off size costs a single run while
+// a recurring size settles into O(1) pops and pushes.
+class PoolRunCache {
+ public:
+  PoolRunCache() = default;
+
+  PoolRunCache(const PoolRunCache&) = delete;
+  PoolRunCache& operator=(const PoolRunCache&) = delete;
+
+  ~PoolRunCache() noexcept { Release(); }
+
+  // Releases every slab and configures the cache for a new run size. Runs
+  // still handed out become dangling.
+  void Reset(size_t bytes, size_t alignment, size_t max_runs_per_slab) noexcept {
+    Release();
+    run_size_ = RunSize(bytes, alignment);
+    alignment_ = alignment;
+    max_runs_per_slab_ = max_runs_per_slab;
+  }
+
+  [[nodiscard]] void* allocate() {
+    if (!free_list_) {
+      Grow();
+    }
+    Run* run = free_list_;
+    free_list_ = run->next;
+    ++live_;
+    return run;
+  }
+
+  void deallocate(void* p) noexcept {
+    Run* run = static_cast<Run*>(p);
+    run->next = free_list_;
+    free_list_ = run;
+    --live_;
+  }
+
+  [[nodiscard]] size_t run_size() const noexcept { return run_size_; }
+  [[nodiscard]] size_t alignment() const noexcept { return alignment_; }
+  [[nodiscard]] size_t live() const noexcept { return live_; }
+
+  static size_t RunSize(size_t bytes, size_t alignment) noexcept {
+    return RoundUp(bytes < sizeof(Run) ? sizeof(Run) : bytes, alignment);
+  }
+
+ private:
+  struct Run {
+    Run* next;
+  };
+
+  struct Slab {
+    Slab* next;
+  };
+
+  static size_t RoundUp(size_t value, size_t alignment) noexcept {
+    return ((value + alignment - 1) / alignment) * alignment;
+  }
+
+  size_t SlabAlignment() const noexcept {
+    return alignment_ < alignof(Slab) ? alignof(Slab) : alignment_;
+  }
+
+  void Grow() {
+    size_t alignment = SlabAlignment();
+    size_t header = RoundUp(sizeof(Slab), alignment);
+    size_t runs = next_slab_runs_;
+    void* memory;
+    try {
+      memory = ::operator new(header + runs * run_size_, std::align_val_t{alignment});
+    } catch (const std::bad_alloc& e) {
+      std::cerr << "PoolAllocator::allocate: Run slab allocation failed: " << e.what() << "\n";
+      throw;
+    }
+    Slab* slab = static_cast<Slab*>(memory);
+    slab->next = slabs_;
+    slabs_ = slab;
+    char* first = static_cast<char*>(memory) + header;
+    for (size_t i = runs; i-- > 0;) {
+      Run* run = reinterpret_cast<Run*>(first + i * run_size_);
+      run->next = free_list_;
+      free_list_ = run;
+    }
+    if (next_slab_runs_ < max_runs_per_slab_) {
+      next_slab_runs_ *= 2;
+    }
+  }
+
+  void Release() noexcept {
+    size_t alignment = SlabAlignment();
+    while (slabs_) {
+      Slab* next = slabs_->next;
+      ::operator delete(slabs_, std::align_val_t{alignment});
+      slabs_ = next;
+    }
+    free_list_ = nullptr;
+    live_ = 0;
+    next_slab_runs_ = 1;
+  }
+
+  size_t run_size_ = 0;
+  size_t alignment_ = 1;
+  size_t max_runs_per_slab_ = 1;
+  size_t live_ = 0;
+  size_t next_slab_runs_ = 1;
+  Run* free_list_ = nullptr;
+  Slab* slabs_ = nullptr;
+};
+
+// Per-size caches for array allocations (allocate(n) with n != 1). Every
+// distinct byte size gets its own PoolRunCache, so recurring sizes (deque
+// blocks, hash buckets) are served in O(1). A cache whose runs are all free
+// can be recycled for a new size once every slot is taken.
+class PoolRunCaches {
+ public:
+  static constexpr size_t kMaxCaches = 8;
+
+  explicit PoolRunCaches(size_t max_runs_per_slab) noexcept
+      : max_runs_per_slab_(max_runs_per_slab) {}
+
+  PoolRunCaches(const PoolRunCaches&) = delete;
+  PoolRunCaches& operator=(const PoolRunCaches&) = delete;
+
+  [[nodiscard]] void* allocate(size_t bytes, size_t alignment) {
+    PoolRunCache* cache = Find(bytes, alignment);
+    if (!cache) {
+      cache = Claim(bytes, alignment);
+    }
+    if (!cache) {
+      std::cerr << "PoolAllocator::allocate: No free run cache for array size " << bytes << "\n";
+      throw std::bad_alloc();
+    }
+    return cache->allocate();
+  }
+
+  void deallocate(void* p, size_t bytes, size_t alignment) noexcept {
+    PoolRunCache* cache = Find(bytes, alignment);
+    if (!cache) return;
+    cache->deallocate(p);
+  }
+
+ private:
+  PoolRunCache* Find(size_t bytes, size_t alignment) noexcept {
+    size_t run_size = PoolRunCache::RunSize(bytes, alignment);
+    for (PoolRunCache& cache : caches_) {
+      if (cache.run_size() == run_size && cache.alignment() == alignment) {
+        return &cache;
+      }
+    }
+    return nullptr;
+  }
+
+  PoolRunCache* Claim(size_t bytes, size_t alignment) noexcept {
+    PoolRunCache* idle = nullptr;
+    for (PoolRunCache& cache : caches_) {
+      if (cache.run_size() == 0) {
+        idle = &cache;
+        break;
+      }
+      if (!idle && cache.live() == 0) {
+        idle = &cache;
+      }
+    }
+    if (!idle) return nullptr;
+    idle->Reset(bytes, alignment, max_runs_per_slab_);
+    return idle;
+  }
+
+  size_t max_runs_per_slab_;
+  PoolRunCache caches_[kMaxCaches];
+};
+
 template <typename T, size_t kBlockSize = 1024>
 class PoolAllocator {
  private:
@@ -19,6 +192,10 @@ class PoolAllocator {
 
   Chunk* free_list_ = nullptr;
   void* memory_block_ = nullptr;
+  std::shared_ptr<PoolRunCaches> run_caches_;
+
+  template <typename U, size_t kOtherBlockSize>
+  friend class PoolAllocator;
 
  public:
   using value_type = T;
@@ -34,8 +211,14 @@ class PoolAllocator {
     using other = PoolAllocator<U, kBlockSize>;
   };
 
-  // Copy constructor: performs a deep copy of the allocator's state.
-  PoolAllocator(const PoolAllocator& other) {
+  // Copy constructor: performs a deep copy of the allocator's state. The copy
+  // gets run caches of its own, since a copied container may be used on
+  // another thread; only rebound allocators share them. A source whose block
+  // was never created (a rebound allocator that has not allocated yet) has
+  // nothing to copy, so the copy creates its block lazily too.
+  PoolAllocator(const PoolAllocator& other)
+      : run_caches_(std::make_shared<PoolRunCaches>(kBlockSize)) {
+    if (!other.memory_block_) return;
     try {
       memory_block_ = ::operator new(kBlockSize * kAlignedSize, std::align_val_t{kAlignment});
     } catch (const std::bad_alloc& e) {
@@ -89,8 +272,18 @@ class PoolAllocator {
     return *this;
   }
 
+  // Rebinding constructor: shares the run caches so that containers which
+  // allocate arrays through temporary rebound allocators (the std::deque map,
+  // std::unordered_map buckets) return them to the same cache. The chunk
+  // block is created on the first single-object allocation.
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U, kBlockSize>& other) noexcept
+      : run_caches_(other.run_caches_) {}
+
   PoolAllocator(PoolAllocator&& other) noexcept
-      : memory_block_(other.memory_block_), free_list_(other.free_list_) {
+      : free_list_(other.free_list_),
+        memory_block_(other.memory_block_),
+        run_caches_(std::move(other.run_caches_)) {
     other.memory_block_ = nullptr;
     other.free_list_ = nullptr;
   }
@@ -102,35 +295,27 @@ class PoolAllocator {
       }
       memory_block_ = other.memory_block_;
       free_list_ = other.free_list_;
+      run_caches_ = std::move(other.run_caches_);
       other.memory_block_ = nullptr;
       other.free_list_ = nullptr;
     }
     return *this;
   }
 
-  PoolAllocator() {
+  PoolAllocator() : run_caches_(std::make_shared<PoolRunCaches>(kBlockSize)) {
     static_assert(kBlockSize > 0, "Block size must be positive");
-    try {
-      memory_block_ = ::operator new(kBlockSize * kAlignedSize, std::align_val_t{kAlignment});
-    } catch (const std::bad_alloc& e) {
-      std::cerr << "Default Constructor: Memory allocation failed: " << e.what() << "\n";
-      throw;
-    }
-    free_list_ = static_cast<Chunk*>(memory_block_);
-    Chunk* current = free_list_;
-    for (size_t i = 0; i < kBlockSize - 1; ++i) {
-      Chunk* next_chunk = reinterpret_cast<Chunk*>(
-          reinterpret_cast<char*>(current) + kAlignedSize);
-      current->next = next_chunk;
-      current = next_chunk;
-    }
-    current->next = nullptr;
+    InitBlock("Default Constructor");
   }
 
   [[nodiscard]] T* allocate(size_t n = 1) {
     if (n != 1) {
-      std::cerr << "PoolAllocator::allocate: Only single object allocations are supported\n";
-      throw std::bad_alloc();
+      if (!run_caches_) {
+        run_caches_ = std::make_shared<PoolRunCaches>(kBlockSize);
+      }
+      return std::launder(static_cast<T*>(run_caches_->allocate(n * sizeof(T), kAlignment)));
+    }
+    if (!memory_block_) {
+      InitBlock("PoolAllocator::allocate");
     }
     if (!free_list_) {
       std::cerr << "PoolAllocator::allocate: Memory pool exhausted\n";
@@ -142,7 +327,13 @@ class PoolAllocator {
   }
 
   void deallocate(T* p, size_t n = 1) noexcept {
-    if (!p || n != 1) return;
+    if (!p) return;
+    if (n != 1) {
+      if (run_caches_) {
+        run_caches_->deallocate(p, n * sizeof(T), kAlignment);
+      }
+      return;
+    }
     Chunk* chunk = std::launder(reinterpret_cast<Chunk*>(p));
     chunk->next = free_list_;
     free_list_ = chunk;
@@ -154,7 +345,12 @@ class PoolAllocator {
     }
   }
 
-  [[nodiscard]] size_t max_size() const noexcept { return kBlockSize; }
+  // Single objects are capped at kBlockSize chunks, but arrays come from
+  // growable run caches, so containers must not treat kBlockSize as a
+  // ceiling on their element count.
+  [[nodiscard]] size_t max_size() const noexcept {
+    return std::numeric_limits<size_t>::max() / sizeof(T);
+  }
 
   [[nodiscard]] bool is_valid() const noexcept { return memory_block_ != nullptr; }
   bool operator==(const PoolAllocator& other) const noexcept {
@@ -167,8 +363,27 @@ class PoolAllocator {
 
 
  private:
+  void InitBlock(const char* context) {
+    try {
+      memory_block_ = ::operator new(kBlockSize * kAlignedSize, std::align_val_t{kAlignment});
+    } catch (const std::bad_alloc& e) {
+      std::cerr << context << ": Memory allocation failed: " << e.what() << "\n";
+      throw;
+    }
+    free_list_ = static_cast<Chunk*>(memory_block_);
+    Chunk* current = free_list_;
+    for (size_t i = 0; i < kBlockSize - 1; ++i) {
+      Chunk* next_chunk = reinterpret_cast<Chunk*>(
+          reinterpret_cast<char*>(current) + kAlignedSize);
+      current->next = next_chunk;
+      current = next_chunk;
+    }
+    current->next = nullptr;
+  }
+
   void swap(PoolAllocator& other) noexcept {
     std::swap(memory_block_, other.memory_block_);
     std::swap(free_list_, other.free_list_);
+    std::swap(run_caches_, other.run_caches_);
   }
 };
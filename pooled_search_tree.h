@@ -0,0 +1,178 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "pool_allocator.h"
+
+// Order in which a PooledSearchTree places its nodes inside its run.
+enum class TreeLayout {
+  kSorted,        // key order, like nodes allocated while inserting sorted input
+  kBreadthFirst,  // level by level (Eytzinger)
+  kVanEmdeBoas,   // recursive blocks of subtrees, cache-oblivious
+};
+
+// Immutable balanced search tree bulk-built in O(n) from sorted input. All
+// nodes are allocated as one contiguous run (with PoolAllocator, from its
+// run caches) and ordered inside it by `layout`, so a lookup walks nodes that
+// share cache lines instead of chasing one allocation per node.
+template <typename K, typename V, typename Compare = std::less<K>,
+          typename Allocator = PoolAllocator<std::pair<const K, V>>>
+class PooledSearchTree {
+ private:
+  struct Node {
+    K key;
+    V value;
+    const Node* left;
+    const Node* right;
+  };
+
+  using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+  using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+  NodeAllocator alloc_;
+  Node* nodes_ = nullptr;
+  const Node* root_ = nullptr;
+  size_t size_ = 0;
+
+ public:
+  using key_type = K;
+  using mapped_type = V;
+  using size_type = size_t;
+
+  // Builds the tree from [first, last), which must be sorted by key.
+  template <typename It>
+  PooledSearchTree(It first, It last, TreeLayout layout = TreeLayout::kVanEmdeBoas,
+                   const Allocator& alloc = Allocator())
+      : alloc_(alloc) {
+    std::vector<std::pair<K, V>> sorted(first, last);
+    size_ = sorted.size();
+    if (size_ == 0) return;
+
+    // Tree shape is the complete binary tree in heap numbering: the node with
+    // breadth-first index b has children 2b+1 and 2b+2. An in-order walk of
+    // that shape hands out the sorted entries.
+    std::vector<size_t> sorted_index(size_);
+    size_t next = 0;
+    AssignInOrder(0, sorted_index, next);
+
+    std::vector<size_t> position(size_);
+    switch (layout) {
+      case TreeLayout::kSorted:
+        position = sorted_index;
+        break;
+      case TreeLayout::kBreadthFirst:
+        for (size_t b = 0; b < size_; ++b) position[b] = b;
+        break;
+      case TreeLayout::kVanEmdeBoas: {
+        size_t placed = 0;
+        LayoutVanEmdeBoas(0, Height(), position, placed);
+        break;
+      }
+    }
+
+    nodes_ = NodeTraits::allocate(alloc_, size_);
+    for (size_t b = 0; b < size_; ++b) {
+      size_t left = 2 * b + 1;
+      size_t right = 2 * b + 2;
+      std::pair<K, V>& entry = sorted[sorted_index[b]];
+      NodeTraits::construct(alloc_, nodes_ + position[b],
+                            Node{std::move(entry.first), std::move(entry.second),
+                                 left < size_ ? nodes_ + position[left] : nullptr,
+                                 right < size_ ? nodes_ + position[right] : nullptr});
+    }
+    root_ = nodes_ + position[0];
+  }
+
+  PooledSearchTree(const PooledSearchTree&) = delete;
+  PooledSearchTree& operator=(const PooledSearchTree&) = delete;
+
+  PooledSearchTree(PooledSearchTree&& other) noexcept
+      : alloc_(std::move(other.alloc_)),
+        nodes_(other.nodes_),
+        root_(other.root_),
+        size_(other.size_) {
+    other.nodes_ = nullptr;
+    other.root_ = nullptr;
+    other.size_ = 0;
+  }
+
+  ~PooledSearchTree() noexcept {
+    if (!nodes_) return;
+    for (size_t i = 0; i < size_; ++i) {
+      NodeTraits::destroy(alloc_, nodes_ + i);
+    }
+    NodeTraits::deallocate(alloc_, nodes_, size_);
+  }
+
+  [[nodiscard]] size_t size() const noexcept { return size_; }
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+  // Returns the value stored under `key`, or nullptr.
+  [[nodiscard]] const V* find(const K& key) const {
+    Compare less;
+    for (const Node* node = root_; node;) {
+      if (less(key, node->key)) {
+        node = node->left;
+      } else if (less(node->key, key)) {
+        node = node->right;
+      } else {
+        return &node->value;
+      }
+    }
+    return nullptr;
+  }
+
+  [[nodiscard]] bool contains(const K& key) const { return find(key) != nullptr; }
+
+  // Calls `fn(key, value)` for every entry in key order.
+  template <typename Fn>
+  void for_each(Fn&& fn) const {
+    Visit(root_, fn);
+  }
+
+ private:
+  size_t Height() const noexcept {
+    size_t height = 0;
+    for (size_t n = size_; n; n >>= 1) ++height;
+    return height;
+  }
+
+  void AssignInOrder(size_t b, std::vector<size_t>& sorted_index, size_t& next) const {
+    if (b >= size_) return;
+    AssignInOrder(2 * b + 1, sorted_index, next);
+    sorted_index[b] = next++;
+    AssignInOrder(2 * b + 2, sorted_index, next);
+  }
+
+  // Places the subtree of `height` levels rooted at breadth-first index
+  // `root`: its top half first, then each bottom subtree left to right.
+  void LayoutVanEmdeBoas(size_t root, size_t height, std::vector<size_t>& position,
+                         size_t& placed) const {
+    if (root >= size_) return;
+    if (height == 1) {
+      position[root] = placed++;
+      return;
+    }
+    size_t bottom = height / 2;
+    size_t top = height - bottom;
+    LayoutVanEmdeBoas(root, top, position, placed);
+    size_t width = size_t{1} << top;
+    size_t first = (root + 1) * width - 1;
+    for (size_t i = 0; i < width && first + i < size_; ++i) {
+      LayoutVanEmdeBoas(first + i, bottom, position, placed);
+    }
+  }
+
+  template <typename Fn>
+  static void Visit(const Node* node, Fn& fn) {
+    if (!node) return;
+    Visit(node->left, fn);
+    fn(node->key, node->value);
+    Visit(node->right, fn);
+  }
+};
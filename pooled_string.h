@@ -0,0 +1,268 @@
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <string_view>
+
+#include "pool_allocator.h"
+
+// Buffer pool for PooledString. Heap buffers come in 32/64/128/256-byte size
+// classes, each backed by its own PoolRunCache; longer strings fall back to
+// ::operator new. Like PoolAllocator, a pool is not thread-safe unless it is
+// constructed `synchronized`, which guards the size classes with a mutex.
+class StringBufferPool {
+ public:
+  static constexpr size_t kClassSizes[] = {32, 64, 128, 256};
+  static constexpr size_t kMaxClassSize = 256;
+
+  static constexpr size_t kClassCount = sizeof(kClassSizes) / sizeof(kClassSizes[0]);
+
+  explicit StringBufferPool(size_t max_buffers_per_slab = 1024, bool synchronized = false) noexcept
+      : synchronized_(synchronized) {
+    for (size_t i = 0; i < kClassCount; ++i) {
+      classes_[i].Reset(kClassSizes[i], alignof(char), max_buffers_per_slab);
+    }
+  }
+
+  StringBufferPool(const StringBufferPool&) = delete;
+  StringBufferPool& operator=(const StringBufferPool&) = delete;
+
+  // Process-wide pool used by PooledString when none is given. Strings on
+  // any thread may share it, so it is synchronized; single-threaded code
+  // avoids the lock by passing a pool of its own.
+  static StringBufferPool& Default() {
+    static StringBufferPool pool(1024, true);
+    return pool;
+  }
+
+  // Smallest buffer size that holds `bytes`: a size class, or `bytes` itself
+  // once it exceeds the largest class.
+  static size_t BufferSize(size_t bytes) noexcept {
+    for (size_t class_size : kClassSizes) {
+      if (bytes <= class_size) return class_size;
+    }
+    return bytes;
+  }
+
+  [[nodiscard]] char* allocate(size_t buffer_size) {
+    if (buffer_size > kMaxClassSize) {
+      return static_cast<char*>(::operator new(buffer_size));
+    }
+    PoolRunCache& cache = classes_[ClassIndex(buffer_size)];
+    if (!synchronized_) return static_cast<char*>(cache.allocate());
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<char*>(cache.allocate());
+  }
+
+  void deallocate(char* p, size_t buffer_size) noexcept {
+    if (buffer_size > kMaxClassSize) {
+      ::operator delete(p);
+      return;
+    }
+    PoolRunCache& cache = classes_[ClassIndex(buffer_size)];
+    if (!synchronized_) {
+      cache.deallocate(p);
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache.deallocate(p);
+  }
+
+ private:
+  // Index of the class whose size is exactly `buffer_size`.
+  static size_t ClassIndex(size_t buffer_size) noexcept {
+    size_t index = 0;
+    while (kClassSizes[index] != buffer_size) ++index;
+    return index;
+  }
+
+  bool synchronized_;
+  std::mutex mutex_;
+  PoolRunCache classes_[kClassCount];
+};
+
+// String with small-string optimization whose long buffers are taken from a
+// StringBufferPool. A heap buffer always spans its whole size class, so
+// growth stays in place until the class is full.
+class PooledString {
+ public:
+  static constexpr size_t kLocalCapacity = 15;
+
+  using value_type = char;
+  using size_type = size_t;
+  using iterator = char*;
+  using const_iterator = const char*;
+
+  explicit PooledString(StringBufferPool& pool = StringBufferPool::Default()) noexcept
+      : pool_(&pool) {
+    local_[0] = '\0';
+  }
+
+  PooledString(std::string_view sv, StringBufferPool& pool = StringBufferPool::Default())
+      : PooledString(pool) {
+    append(sv);
+  }
+
+  PooledString(const char* s, StringBufferPool& pool = StringBufferPool::Default())
+      : PooledString(std::string_view(s), pool) {}
+
+  PooledString(const PooledString& other) : PooledString(other.view(), *other.pool_) {}
+
+  PooledString(PooledString&& other) noexcept : pool_(other.pool_) { steal(other); }
+
+  PooledString& operator=(const PooledString& other) {
+    if (this != &other) {
+      assign(other.view());
+    }
+    return *this;
+  }
+
+  PooledString& operator=(PooledString&& other) noexcept {
+    if (this != &other) {
+      release();
+      data_ = local_;
+      pool_ = other.pool_;
+      steal(other);
+    }
+    return *this;
+  }
+
+  PooledString& operator=(std::string_view sv) {
+    assign(sv);
+    return *this;
+  }
+
+  ~PooledString() noexcept { release(); }
+
+  [[nodiscard]] size_t size() const noexcept { return size_; }
+  [[nodiscard]] size_t length() const noexcept { return size_; }
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+  [[nodiscard]] size_t capacity() const noexcept {
+    return is_local() ? kLocalCapacity : capacity_;
+  }
+
+  [[nodiscard]] const char* data() const noexcept { return data_; }
+  [[nodiscard]] char* data() noexcept { return data_; }
+  [[nodiscard]] const char* c_str() const noexcept { return data_; }
+
+  char& operator[](size_t i) noexcept { return data_[i]; }
+  const char& operator[](size_t i) const noexcept { return data_[i]; }
+
+  iterator begin() noexcept { return data_; }
+  iterator end() noexcept { return data_ + size_; }
+  const_iterator begin() const noexcept { return data_; }
+  const_iterator end() const noexcept { return data_ + size_; }
+
+  [[nodiscard]] std::string_view view() const noexcept { return {data_, size_}; }
+  operator std::string_view() const noexcept { return view(); }
+
+  void reserve(size_t new_capacity) {
+    if (new_capacity > capacity()) {
+      grow(new_capacity);
+    }
+  }
+
+  void clear() noexcept {
+    size_ = 0;
+    data_[0] = '\0';
+  }
+
+  void push_back(char c) {
+    if (size_ == capacity()) {
+      grow(size_ + 1);
+    }
+    data_[size_++] = c;
+    data_[size_] = '\0';
+  }
+
+  // `sv` may view this string.
+  PooledString& append(std::string_view sv) {
+    if (size_ + sv.size() > capacity()) {
+      grow(size_ + sv.size(), sv);
+      return *this;
+    }
+    std::memmove(data_ + size_, sv.data(), sv.size());
+    size_ += sv.size();
+    data_[size_] = '\0';
+    return *this;
+  }
+
+  PooledString& operator+=(std::string_view sv) { return append(sv); }
+  PooledString& operator+=(char c) {
+    push_back(c);
+    return *this;
+  }
+
+  // `sv` may view this string.
+  void assign(std::string_view sv) {
+    if (sv.size() > capacity()) {
+      size_ = 0;
+      grow(sv.size(), sv);
+      return;
+    }
+    std::memmove(data_, sv.data(), sv.size());
+    size_ = sv.size();
+    data_[size_] = '\0';
+  }
+
+  friend bool operator==(const PooledString& a, std::string_view b) noexcept {
+    return a.view() == b;
+  }
+  friend bool operator!=(const PooledString& a, std::string_view b) noexcept {
+    return a.view() != b;
+  }
+  friend std::ostream& operator<<(std::ostream& os, const PooledString& s) {
+    return os << s.view();
+  }
+
+ private:
+  [[nodiscard]] bool is_local() const noexcept { return data_ == local_; }
+
+  // Moves the contents, followed by `tail`, into a buffer of the size class
+  // that fits at least `min_capacity` characters, doubling first so appends
+  // stay amortized O(1) past the largest class. Both are copied before the
+  // old buffer is released, so `tail` may point into it.
+  void grow(size_t min_capacity, std::string_view tail = {}) {
+    size_t wanted = std::max(min_capacity, capacity() * 2) + 1;
+    size_t buffer_size = StringBufferPool::BufferSize(wanted);
+    char* buffer = pool_->allocate(buffer_size);
+    std::memcpy(buffer, data_, size_);
+    if (!tail.empty()) std::memcpy(buffer + size_, tail.data(), tail.size());
+    size_ += tail.size();
+    buffer[size_] = '\0';
+    release();
+    data_ = buffer;
+    capacity_ = buffer_size - 1;
+  }
+
+  // Takes over `other`'s contents, leaving it empty. Expects this string to
+  // hold no heap buffer.
+  void steal(PooledString& other) noexcept {
+    size_ = other.size_;
+    if (other.is_local()) {
+      std::memcpy(local_, other.local_, other.size_ + 1);
+    } else {
+      data_ = other.data_;
+      capacity_ = other.capacity_;
+      other.data_ = other.local_;
+    }
+    other.size_ = 0;
+    other.local_[0] = '\0';
+  }
+
+  void release() noexcept {
+    if (!is_local()) {
+      pool_->deallocate(data_, capacity_ + 1);
+    }
+  }
+
+  StringBufferPool* pool_;
+  char* data_ = local_;
+  size_t size_ = 0;
+  union {
+    size_t capacity_;
+    char local_[kLocalCapacity + 1];
+  };
+};
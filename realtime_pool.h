@@ -0,0 +1,90 @@
+#pragma once
+#include <sys/mman.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <system_error>
+
+// Fixed-capacity pool for real-time loops. All memory is allocated, touched
+// and (optionally) locked with mlock() in the constructor; after that,
+// allocate() and deallocate() are a handful of instructions with no system
+// calls, no growth and no logging, so their worst case is bounded by the
+// hardware rather than by the kernel or the allocator. Exhaustion is reported
+// by returning nullptr. Like PoolAllocator, it is not thread-safe.
+template <typename T, size_t kCapacity>
+class RealTimePool {
+  static_assert(kCapacity > 0, "Capacity must be positive");
+
+ private:
+  union Chunk {
+    Chunk* next;
+    alignas(T) char data[sizeof(T)];
+  };
+
+  static constexpr size_t kBytes = kCapacity * sizeof(Chunk);
+
+  Chunk* free_list_ = nullptr;
+  Chunk* memory_block_ = nullptr;
+  size_t in_use_ = 0;
+  bool locked_ = false;
+
+ public:
+  using value_type = T;
+
+  // With `require_lock`, failing to lock the block in RAM (typically
+  // RLIMIT_MEMLOCK) throws std::system_error instead of being reported by
+  // is_locked().
+  explicit RealTimePool(bool require_lock = true) {
+    try {
+      memory_block_ = static_cast<Chunk*>(::operator new(kBytes, std::align_val_t{alignof(Chunk)}));
+    } catch (const std::bad_alloc& e) {
+      std::cerr << "RealTimePool: Memory allocation failed: " << e.what() << "\n";
+      throw;
+    }
+    // Writing every byte faults in every page now rather than on first use.
+    std::memset(static_cast<void*>(memory_block_), 0, kBytes);
+    if (mlock(memory_block_, kBytes) == 0) {
+      locked_ = true;
+    } else if (require_lock) {
+      int error = errno;
+      std::cerr << "RealTimePool: mlock failed: " << std::strerror(error) << "\n";
+      ::operator delete(memory_block_, std::align_val_t{alignof(Chunk)});
+      throw std::system_error(error, std::system_category(), "RealTimePool: mlock");
+    }
+    for (size_t i = kCapacity; i-- > 0;) {
+      memory_block_[i].next = free_list_;
+      free_list_ = &memory_block_[i];
+    }
+  }
+
+  RealTimePool(const RealTimePool&) = delete;
+  RealTimePool& operator=(const RealTimePool&) = delete;
+
+  ~RealTimePool() noexcept {
+    if (locked_) munlock(memory_block_, kBytes);
+    ::operator delete(memory_block_, std::align_val_t{alignof(Chunk)});
+  }
+
+  // Returns uninitialized storage for one T, or nullptr when exhausted.
+  [[nodiscard]] T* allocate() noexcept {
+    Chunk* chunk = free_list_;
+    if (!chunk) return nullptr;
+    free_list_ = chunk->next;
+    ++in_use_;
+    return std::launder(reinterpret_cast<T*>(chunk->data));
+  }
+
+  void deallocate(T* p) noexcept {
+    if (!p) return;
+    Chunk* chunk = std::launder(reinterpret_cast<Chunk*>(p));
+    chunk->next = free_list_;
+    free_list_ = chunk;
+    --in_use_;
+  }
+
+  [[nodiscard]] size_t capacity() const noexcept { return kCapacity; }
+  [[nodiscard]] size_t in_use() const noexcept { return in_use_; }
+  [[nodiscard]] bool is_locked() const noexcept { return locked_; }
+};
@@ -0,0 +1,174 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <new>
+#include <utility>
+
+// Bounded single-producer single-consumer ring of pointers. Head and tail sit
+// on separate cache lines, and each side caches the other's index so that it
+// only reads the shared atomic when the ring looks full or empty.
+template <typename T, size_t kCapacity>
+class SpscRing {
+  static_assert(kCapacity > 0 && (kCapacity & (kCapacity - 1)) == 0,
+                "Ring capacity must be a power of two");
+
+ public:
+  // Producer side: appends up to `count` pointers, returns how many fit.
+  size_t push(T* const* items, size_t count) noexcept {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (kCapacity - (tail - cached_head_) < count) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+    }
+    size_t room = kCapacity - (tail - cached_head_);
+    if (count > room) count = room;
+    for (size_t i = 0; i < count; ++i) {
+      slots_[(tail + i) & (kCapacity - 1)] = items[i];
+    }
+    if (count) tail_.store(tail + count, std::memory_order_release);
+    return count;
+  }
+
+  bool push(T* item) noexcept { return push(&item, 1) == 1; }
+
+  // Consumer side: removes up to `count` pointers, returns how many it got.
+  size_t pop(T** items, size_t count) noexcept {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (cached_tail_ - head < count) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+    }
+    size_t available = cached_tail_ - head;
+    if (count > available) count = available;
+    for (size_t i = 0; i < count; ++i) {
+      items[i] = slots_[(head + i) & (kCapacity - 1)];
+    }
+    if (count) head_.store(head + count, std::memory_order_release);
+    return count;
+  }
+
+  T* pop() noexcept {
+    T* item = nullptr;
+    pop(&item, 1);
+    return item;
+  }
+
+ private:
+  alignas(64) std::atomic<size_t> head_{0};
+  size_t cached_tail_ = 0;
+  alignas(64) std::atomic<size_t> tail_{0};
+  size_t cached_head_ = 0;
+  alignas(64) T* slots_[kCapacity];
+};
+
+// Zero-allocation message channel between one producer and one consumer
+// thread. Every message lives in a block preallocated at construction. The
+// producer takes free messages from a private free list and sends them over
+// one ring; the consumer hands processed messages back over a second ring in
+// batches of kRecycleBatch. Steady-state messaging therefore performs no
+// allocator calls and no atomics beyond the two rings' index updates.
+template <typename T, size_t kCapacity = 1024, size_t kRecycleBatch = 32>
+class SpscChannel {
+  static_assert(kRecycleBatch <= kCapacity, "Recycle batch must fit in the ring");
+
+ private:
+  union Slot {
+    Slot* next;
+    alignas(T) char data[sizeof(T)];
+  };
+
+  SpscRing<Slot, kCapacity> messages_;
+  SpscRing<Slot, kCapacity> recycled_;
+  Slot* block_ = nullptr;
+
+  // Producer-only state.
+  alignas(64) Slot* free_list_ = nullptr;
+
+  // Consumer-only state.
+  alignas(64) Slot* pending_[kRecycleBatch];
+  size_t pending_count_ = 0;
+
+ public:
+  SpscChannel() {
+    try {
+      block_ = static_cast<Slot*>(::operator new(kCapacity * sizeof(Slot),
+                                                 std::align_val_t{alignof(Slot)}));
+    } catch (const std::bad_alloc& e) {
+      std::cerr << "SpscChannel: Memory allocation failed: " << e.what() << "\n";
+      throw;
+    }
+    for (size_t i = kCapacity; i-- > 0;) {
+      block_[i].next = free_list_;
+      free_list_ = &block_[i];
+    }
+  }
+
+  SpscChannel(const SpscChannel&) = delete;
+  SpscChannel& operator=(const SpscChannel&) = delete;
+
+  // Destroys messages still in flight. No thread may be using the channel.
+  ~SpscChannel() noexcept {
+    while (Slot* slot = messages_.pop()) {
+      std::launder(reinterpret_cast<T*>(slot->data))->~T();
+    }
+    ::operator delete(block_, std::align_val_t{alignof(Slot)});
+  }
+
+  // Producer: constructs a message and sends it. Returns false, without
+  // constructing, when every message is in flight or awaiting recycling.
+  template <typename... Args>
+  bool try_send(Args&&... args) {
+    if (!free_list_ && !Reclaim()) return false;
+    Slot* slot = free_list_;
+    free_list_ = slot->next;
+    try {
+      new (slot->data) T(std::forward<Args>(args)...);
+    } catch (...) {
+      slot->next = free_list_;
+      free_list_ = slot;
+      throw;
+    }
+    messages_.push(slot);
+    return true;
+  }
+
+  // Consumer: returns the next message, or nullptr. The message stays valid
+  // until it is passed to release(). An empty channel flushes any partial
+  // recycle batch so the producer never waits on messages held back here.
+  T* try_receive() noexcept {
+    Slot* slot = messages_.pop();
+    if (!slot) {
+      if (pending_count_) flush();
+      return nullptr;
+    }
+    return std::launder(reinterpret_cast<T*>(slot->data));
+  }
+
+  // Consumer: destroys a processed message and queues it for the producer.
+  void release(T* message) noexcept {
+    message->~T();
+    pending_[pending_count_++] = reinterpret_cast<Slot*>(message);
+    if (pending_count_ == kRecycleBatch) flush();
+  }
+
+  // Consumer: hands queued messages back to the producer now rather than
+  // waiting for a full batch.
+  void flush() noexcept {
+    size_t pushed = recycled_.push(pending_, pending_count_);
+    for (size_t i = pushed; i < pending_count_; ++i) {
+      pending_[i - pushed] = pending_[i];
+    }
+    pending_count_ -= pushed;
+  }
+
+ private:
+  // Producer: refills the free list from the recycle ring.
+  bool Reclaim() noexcept {
+    Slot* batch[kRecycleBatch];
+    size_t count = recycled_.pop(batch, kRecycleBatch);
+    for (size_t i = 0; i < count; ++i) {
+      batch[i]->next = free_list_;
+      free_list_ = batch[i];
+    }
+    return count != 0;
+  }
+};
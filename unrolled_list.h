@@ -0,0 +1,263 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "pool_allocator.h"
+
+// Doubly linked list of pooled nodes that each hold a cache line's worth of
+// elements (at least one). Elements are packed at the front of their node, so
+// iteration streams through whole lines instead of chasing one pointer per
+// element, and insert/erase shift at most one node's elements. Inserting into
+// a full node spills into the previous node if it has room, starts a fresh
+// node when appending at the tail or prepending at the head (so sequential
+// fills stay dense), and splits the node in two otherwise. A node that drops
+// below a quarter full absorbs its successor when both fit. Insert and erase
+// invalidate iterators into the nodes they touch.
+template <typename T, typename Allocator = PoolAllocator<T>>
+class UnrolledList {
+  static_assert(std::is_nothrow_move_constructible<T>::value,
+                "Elements are relocated between slots and must not throw on move");
+
+ public:
+  static constexpr size_t kNodeCapacity = std::max<size_t>(64 / sizeof(T), 1);
+
+ private:
+  struct Node {
+    Node* prev = nullptr;
+    Node* next = nullptr;
+    size_t count = 0;
+    alignas(T) char data[kNodeCapacity * sizeof(T)];
+
+    Node() noexcept {}
+    T* items() noexcept { return std::launder(reinterpret_cast<T*>(data)); }
+  };
+
+  using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+  using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+  template <bool kConst>
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<kConst, const T*, T*>;
+    using reference = std::conditional_t<kConst, const T&, T&>;
+
+    Iterator() noexcept = default;
+    template <bool kOtherConst, typename = std::enable_if_t<kConst && !kOtherConst>>
+    Iterator(const Iterator<kOtherConst>& other) noexcept  // NOLINT: iterator -> const_iterator
+        : node_(other.node_), index_(other.index_) {}
+
+    reference operator*() const noexcept { return node_->items()[index_]; }
+    pointer operator->() const noexcept { return node_->items() + index_; }
+
+    Iterator& operator++() noexcept {
+      if (++index_ == node_->count) {
+        node_ = node_->next;
+        index_ = 0;
+      }
+      return *this;
+    }
+
+    Iterator operator++(int) noexcept {
+      Iterator copy = *this;
+      ++*this;
+      return copy;
+    }
+
+    friend bool operator==(const Iterator& a, const Iterator& b) noexcept {
+      return a.node_ == b.node_ && a.index_ == b.index_;
+    }
+    friend bool operator!=(const Iterator& a, const Iterator& b) noexcept { return !(a == b); }
+
+   private:
+    friend class UnrolledList;
+    template <bool>
+    friend class Iterator;
+
+    Iterator(Node* node, size_t index) noexcept : node_(node), index_(index) {}
+
+    Node* node_ = nullptr;
+    size_t index_ = 0;
+  };
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  explicit UnrolledList(const Allocator& alloc = Allocator()) : alloc_(alloc) {}
+
+  UnrolledList(const UnrolledList&) = delete;
+  UnrolledList& operator=(const UnrolledList&) = delete;
+
+  UnrolledList(UnrolledList&& other) noexcept
+      : alloc_(std::move(other.alloc_)),
+        head_(other.head_),
+        tail_(other.tail_),
+        size_(other.size_) {
+    other.head_ = nullptr;
+    other.tail_ = nullptr;
+    other.size_ = 0;
+  }
+
+  ~UnrolledList() noexcept { clear(); }
+
+  [[nodiscard]] size_t size() const noexcept { return size_; }
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+  iterator begin() noexcept { return iterator(head_, 0); }
+  iterator end() noexcept { return iterator(); }
+  const_iterator begin() const noexcept { return const_iterator(head_, 0); }
+  const_iterator end() const noexcept { return const_iterator(); }
+
+  T& front() noexcept { return head_->items()[0]; }
+  const T& front() const noexcept { return head_->items()[0]; }
+  T& back() noexcept { return tail_->items()[tail_->count - 1]; }
+  const T& back() const noexcept { return tail_->items()[tail_->count - 1]; }
+
+  void push_back(const T& value) { emplace(end(), value); }
+  void push_back(T&& value) { emplace(end(), std::move(value)); }
+  void push_front(const T& value) { emplace(begin(), value); }
+  void push_front(T&& value) { emplace(begin(), std::move(value)); }
+
+  template <typename... Args>
+  T& emplace_back(Args&&... args) {
+    return *emplace(end(), std::forward<Args>(args)...);
+  }
+
+  void pop_back() noexcept { erase(const_iterator(tail_, tail_->count - 1)); }
+  void pop_front() noexcept { erase(begin()); }
+
+  iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+  iterator insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
+
+  // Constructs an element before `pos` and returns an iterator to it. The
+  // element is built before anything shifts, so `args` may refer to elements
+  // of this list.
+  template <typename... Args>
+  iterator emplace(const_iterator pos, Args&&... args) {
+    T value(std::forward<Args>(args)...);
+    Node* node = pos.node_;
+    size_t index = pos.index_;
+    if (!node) {
+      node = tail_;
+      index = node ? node->count : 0;
+    }
+    if (!node) {
+      node = NewNode(nullptr);
+    } else if (node->count == kNodeCapacity) {
+      if (index == 0 && node->prev && node->prev->count < kNodeCapacity) {
+        node = node->prev;
+        index = node->count;
+      } else if (index == kNodeCapacity) {
+        node = NewNode(node);
+        index = 0;
+      } else if (index == 0 && node->prev == nullptr) {
+        node = NewNode(nullptr);
+      } else {
+        Node* upper = NewNode(node);
+        size_t half = kNodeCapacity / 2;
+        Relocate(upper->items(), node->items() + half, kNodeCapacity - half);
+        upper->count = kNodeCapacity - half;
+        node->count = half;
+        if (index > half) {
+          node = upper;
+          index -= half;
+        }
+      }
+    }
+    T* items = node->items();
+    for (size_t i = node->count; i > index; --i) Relocate(items + i, items + i - 1, 1);
+    new (items + index) T(std::move(value));
+    ++node->count;
+    ++size_;
+    return iterator(node, index);
+  }
+
+  // Removes the element at `pos` and returns an iterator to the one after it.
+  iterator erase(const_iterator pos) noexcept {
+    Node* node = pos.node_;
+    size_t index = pos.index_;
+    T* items = node->items();
+    items[index].~T();
+    for (size_t i = index + 1; i < node->count; ++i) Relocate(items + i - 1, items + i, 1);
+    --node->count;
+    --size_;
+    if (node->count == 0) {
+      Node* next = node->next;
+      FreeNode(node);
+      return iterator(next, 0);
+    }
+    Node* next = node->next;
+    if (next && node->count < kNodeCapacity / 4 && node->count + next->count <= kNodeCapacity) {
+      Relocate(items + node->count, next->items(), next->count);
+      node->count += next->count;
+      next->count = 0;
+      FreeNode(next);
+    }
+    return index < node->count ? iterator(node, index) : iterator(node->next, 0);
+  }
+
+  void clear() noexcept {
+    for (Node* node = head_; node;) {
+      Node* next = node->next;
+      T* items = node->items();
+      for (size_t i = 0; i < node->count; ++i) items[i].~T();
+      NodeTraits::destroy(alloc_, node);
+      NodeTraits::deallocate(alloc_, node, 1);
+      node = next;
+    }
+    head_ = nullptr;
+    tail_ = nullptr;
+    size_ = 0;
+  }
+
+  // Number of pooled nodes, for measuring how densely the list is packed.
+  [[nodiscard]] size_t node_count() const noexcept {
+    size_t count = 0;
+    for (const Node* node = head_; node; node = node->next) ++count;
+    return count;
+  }
+
+ private:
+  // Moves `count` elements from `source` to the uninitialized `target`.
+  static void Relocate(T* target, T* source, size_t count) noexcept {
+    for (size_t i = 0; i < count; ++i) {
+      new (target + i) T(std::move(source[i]));
+      source[i].~T();
+    }
+  }
+
+  // Links an empty node in after `prev`, or at the front when null.
+  Node* NewNode(Node* prev) {
+    Node* node = NodeTraits::allocate(alloc_, 1);
+    NodeTraits::construct(alloc_, node);
+    node->prev = prev;
+    node->next = prev ? prev->next : head_;
+    (node->next ? node->next->prev : tail_) = node;
+    (prev ? prev->next : head_) = node;
+    return node;
+  }
+
+  void FreeNode(Node* node) noexcept {
+    (node->prev ? node->prev->next : head_) = node->next;
+    (node->next ? node->next->prev : tail_) = node->prev;
+    NodeTraits::destroy(alloc_, node);
+    NodeTraits::deallocate(alloc_, node, 1);
+  }
+
+  NodeAllocator alloc_;
+  Node* head_ = nullptr;
+  Node* tail_ = nullptr;
+  size_t size_ = 0;
+};